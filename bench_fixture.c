@@ -0,0 +1,204 @@
+// ********************************************************************************
+// Teacher-Network Data and Train-to-Error Runs Shared by the Training Benchmarks
+// ********************************************************************************
+
+#define _POSIX_C_SOURCE 200809L
+
+// Include Libraries
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <omp.h>
+
+#include "bench_fixture.h"
+#include "rng.h"
+
+// ***********************************
+// Helper Functions
+// ***********************************
+
+// Helper Function to Get Monotonic Time in Seconds
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+// ***********************************
+// Data
+// ***********************************
+
+// Function to Fill a Network's Weights, Bias Included, with Values in [-scale, scale)
+void randomWeights(Network *net, uint64_t seed, double scale)
+{
+    for (int l = 0; l < net->n_layers; l++)
+    {
+        Layer *layer = &net->layers[l];
+
+        for (int i = 0; i < layer->out; i++)
+        {
+            for (int j = 0; j <= layer->in; j++)
+            {
+                const size_t k = (size_t)i * layer->stride + j;
+
+                layer->W[k] = scale * (2 * rngUniform(seed, RngWeights, layer->offset + k) - 1);
+            }
+        }
+    }
+}
+
+// Function to Fill Inputs and the Targets a Random Teacher Network Gives for Them
+// Teacher Weights and Inputs Are in [-1, 1), so the Targets Are Spread Out Rather Than Saturated
+int teacherData(const int *widths, int n_widths, uint64_t seed, int samples, double *in, double *target)
+{
+    const int in_n = widths[0];
+    const int out_n = widths[n_widths - 1];
+
+    Network *teacher = createNN(widths, n_widths, FixtureRate, PrecisionDouble);
+    Workspace *ws = (teacher != NULL) ? createWorkspace(teacher, 1) : NULL;
+
+    if (ws == NULL)
+    {
+        freeNN(teacher);
+        return -1;
+    }
+
+    randomWeights(teacher, seed, 1.0);
+
+    for (int s = 0; s < samples; s++)
+    {
+        for (int i = 0; i < in_n; i++)
+            in[(size_t)s * in_n + i] = 2 * rngUniform(seed, RngInputs, (size_t)s * in_n + i) - 1;
+
+        activateNN(teacher, ws, in + (size_t)s * in_n);
+        memcpy(target + (size_t)s * out_n, outputNN(teacher, ws), out_n * sizeof(double));
+    }
+
+    freeWorkspace(ws);
+    freeNN(teacher);
+
+    return 0;
+}
+
+// ***********************************
+// Train to Error
+// ***********************************
+
+// Function to Train from init Until the Mean Error per Sample Reaches FixtureMaxError
+double trainToError(Network *net, const double *init, const double *in, const double *target, int samples, int step,
+                    TrainMode mode, int threads, int *epochs, double *error)
+{
+    const int in_n = net->widths[0];
+    const int out_n = net->widths[net->n_layers];
+    Workspace *ws[threads];
+    double *grads[threads];
+    double shard_error[threads];
+    double total_error = 1;
+    int epoch = 0;
+
+    memcpy(net->weights, init, net->n_weights * sizeof(double));
+    net->learn_rate = (mode == TrainSerialBatch || mode == TrainData) ? FixtureStepRate : FixtureRate;
+
+    for (int t = 0; t < threads; t++)
+    {
+        ws[t] = createWorkspace(net, step);
+        grads[t] = createGradient(net);
+        shard_error[t] = 0;
+    }
+
+    const double start = now();
+
+    if (mode == TrainSerial || mode == TrainSerialBatch)
+    {
+        for (; total_error > FixtureMaxError && epoch < FixtureMaxEpochs; epoch++)
+        {
+            double sum = 0;
+
+            for (int s = 0; s < samples; s += (mode == TrainSerial) ? 1 : step)
+            {
+                const double *x = in + (size_t)s * in_n;
+                const double *y = target + (size_t)s * out_n;
+
+                if (mode == TrainSerial)
+                {
+                    activateNN(net, ws[0], x);
+                    sum += calcError(net, ws[0], y);
+                    trainNN(net, ws[0], y);
+                }
+                else
+                {
+                    activateNNBatch(net, ws[0], x, step);
+                    sum += calcErrorBatch(net, ws[0], y, step) * step;
+                    trainNNBatch(net, ws[0], y, step);
+                }
+            }
+
+            total_error = sum / samples;
+        }
+    }
+    else
+    {
+        #pragma omp parallel num_threads(threads)
+        {
+            while (total_error > FixtureMaxError && epoch < FixtureMaxEpochs)
+            {
+                const int tid = omp_get_thread_num();
+
+                if (mode == TrainTeam)
+                {
+                    for (int s = 0; s < samples; s++)
+                    {
+                        activateNNTeam(net, ws[0], in + (size_t)s * in_n);
+
+                        #pragma omp single
+                        shard_error[0] += calcError(net, ws[0], target + (size_t)s * out_n);
+
+                        trainNNTeam(net, ws[0], target + (size_t)s * out_n);
+                    }
+                }
+                else if (mode == TrainHogwild)
+                {
+                    shard_error[tid] = trainNNHogwild(net, ws[tid], in, target, samples);
+                }
+                else
+                {
+                    double sum = 0;
+
+                    for (int s = 0; s < samples; s += step)
+                        sum += trainNNData(net, ws[tid], grads, in + (size_t)s * in_n, target + (size_t)s * out_n, step) * step;
+
+                    if (tid == 0)           // Every Thread Gets the Whole Step's Error
+                        shard_error[0] = sum;
+                }
+
+                #pragma omp barrier
+
+                #pragma omp single
+                {
+                    total_error = 0;
+                    for (int t = 0; t < omp_get_num_threads(); t++)
+                    {
+                        total_error += shard_error[t] / samples;
+                        shard_error[t] = 0;
+                    }
+                    epoch++;
+                }
+            }
+        }
+    }
+
+    const double elapsed = now() - start;
+
+    for (int t = 0; t < threads; t++)
+    {
+        freeWorkspace(ws[t]);
+        freeGradient(grads[t]);
+    }
+
+    *epochs = epoch;
+    *error = total_error;
+
+    return elapsed;
+}
@@ -0,0 +1,42 @@
+// ********************************************************************************
+// Teacher-Network Data and Train-to-Error Runs Shared by the Training Benchmarks
+// ********************************************************************************
+
+#ifndef BENCH_FIXTURE_H
+#define BENCH_FIXTURE_H
+
+#include "network.h"
+
+// Definitions - Macros
+#define FixtureRate 0.4             // Per-Sample Rate, as in ebp.c
+#define FixtureStepRate 4.0         // Rate of Updates Averaged over a Whole Step
+#define FixtureMaxError 0.001       // Mean Error per Sample a Run Trains To
+#define FixtureMaxEpochs 5000       // A Run That Has Not Converged by Then is Reported as Such
+
+// Training Modes, Serial as in ebp.c and OpenMP as in ebp_omp00.c
+typedef enum
+{
+    TrainSerial,        // Per-Sample activateNN, calcError, trainNN
+    TrainSerialBatch,   // One Averaged trainNNBatch Update per Step
+    TrainTeam,          // Per-Sample Team Passes, the Threads Splitting Each Layer
+    TrainData,          // Data-Parallel trainNNData Steps
+    TrainHogwild,       // Lock-Free trainNNHogwild Updates
+    TrainModes
+} TrainMode;
+
+// Function to Fill a Network's Weights, Bias Included, with Values in [-scale, scale)
+// Drawn from the Seed's Weight Stream at Each Weight's Position in the Arena
+void randomWeights(Network *net, uint64_t seed, double scale);
+
+// Function to Fill in[samples][in_n] from the Seed's Input Stream and target[samples][out_n] with
+// the Outputs of a Teacher Network Whose Weights Come from the Seed, so Targets Are Learnable
+// Returns 0 on Success, -1 If the Teacher Cannot Be Allocated
+int teacherData(const int *widths, int n_widths, uint64_t seed, int samples, double *in, double *target);
+
+// Function to Train net from the Weights in init Until the Mean Error per Sample Reaches FixtureMaxError
+// Steps of the Batched and Data-Parallel Modes Are step Samples, a Divisor of samples
+// Returns Seconds Taken, Errors Are Measured Before Each Epoch's Updates
+double trainToError(Network *net, const double *init, const double *in, const double *target, int samples, int step,
+                    TrainMode mode, int threads, int *epochs, double *error);
+
+#endif
@@ -0,0 +1,63 @@
+// ********************************************************************************
+// Wall-Clock Time to max_error of Synchronous All-Reduce Against Hogwild Training
+// ********************************************************************************
+
+// Include Libraries
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#include "network.h"
+#include "bench_fixture.h"
+
+// Definitions - Macros
+#define Topology "12,100,10"
+#define Samples 256             // Training Set Size, Sharded Across the Team
+#define StepSamples 32          // Samples per Synchronous Step, a Divisor of Samples
+
+// Driver Function, Optional Argument is the Largest Thread Count to Try
+int main(int argc, char *argv[])
+{
+    int widths[MaxLayers];
+    int n_widths = parseTopology(Topology, widths, MaxLayers);
+    int max_threads = (argc > 1) ? atoi(argv[1]) : omp_get_max_threads();
+
+    Network *net = createNN(widths, n_widths, FixtureRate, PrecisionDouble);
+    double *init = malloc((net != NULL ? net->n_weights : 0) * sizeof(double));
+    double *in = malloc((size_t)Samples * widths[0] * sizeof(double));
+    double *target = malloc((size_t)Samples * widths[n_widths - 1] * sizeof(double));
+
+    if (net == NULL || init == NULL || in == NULL || target == NULL || max_threads < 1 ||
+        teacherData(widths, n_widths, 1, Samples, in, target) != 0)
+    {
+        fprintf(stderr, "Failed to Allocate Benchmark!\n");
+        return 1;
+    }
+
+    randomWeights(net, 2, 0.25);
+    memcpy(init, net->weights, net->n_weights * sizeof(double));
+
+    printf("%-12s %8s %8s %12s %12s\n", "Mode", "Threads", "Epochs", "Seconds", "Error");
+
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        for (int hogwild = 0; hogwild <= 1; hogwild++)
+        {
+            int epochs;
+            double error;
+            double elapsed = trainToError(net, init, in, target, Samples, StepSamples, hogwild ? TrainHogwild : TrainData,
+                                          threads, &epochs, &error);
+
+            printf("%-12s %8d %8d %12.4f %12.3e%s\n", hogwild ? "hogwild" : "all-reduce", threads, epochs,
+                   elapsed, error, (error > FixtureMaxError) ? " (Not Converged)" : "");
+        }
+    }
+
+    free(init);
+    free(in);
+    free(target);
+    freeNN(net);
+
+    return 0;
+}
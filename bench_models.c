@@ -0,0 +1,180 @@
+// ********************************************************************************
+// Throughput of Many Independent Small Networks Trained Concurrently, One Thread Each
+// ********************************************************************************
+
+#define _POSIX_C_SOURCE 200809L
+
+// Include Libraries
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "network.h"
+#include "bench_fixture.h"
+
+// Definitions - Macros
+#define Topology "12,32,10"
+#define Models 32               // Independent Networks, Each with Its Own Data
+#define Samples 256             // Training Set Size per Network
+#define MiniBatch 16            // Samples per Training Step
+#define Epochs 200              // Passes over Each Network's Training Set
+
+const double learn_rate = 0.4;
+
+// Everything One Network Owns, Nothing Here is Touched by Another Thread
+// Cache Line Aligned, so Neighbouring Models' Results Never Share a Line
+typedef struct
+{
+    uint64_t seed;
+    Network *net;
+    Workspace *ws;
+    double *in;                 // Inputs [Samples][in_n]
+    double *target;             // Targets [Samples][out_n], a Teacher Network's Outputs
+    double error;               // Mean Error After Training
+} __attribute__((aligned(CacheLine))) Model;
+
+// Models a Thread Trains, Every step-th Starting at first
+typedef struct
+{
+    Model *models;
+    int first;
+    int step;
+} Share;
+
+// Helper Function to Get Monotonic Time in Seconds
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+// Helper Function to Create a Model and Its Data, Targets Coming from a Teacher with Another Seed
+static int createModel(Model *m, const int *widths, int n_widths, uint64_t seed)
+{
+    m->seed = seed;
+    m->net = createNN(widths, n_widths, learn_rate, PrecisionDouble);
+    m->ws = (m->net != NULL) ? createWorkspace(m->net, MiniBatch) : NULL;
+    m->in = malloc((size_t)Samples * widths[0] * sizeof(double));
+    m->target = malloc((size_t)Samples * widths[n_widths - 1] * sizeof(double));
+
+    if (m->ws == NULL || m->in == NULL || m->target == NULL)
+        return -1;
+
+    return teacherData(widths, n_widths, seed + Models, Samples, m->in, m->target);
+}
+
+// Helper Function to Train a Model from Its Initial Weights, Storing Its Final Mean Error
+static void trainModel(Model *m)
+{
+    Network *net = m->net;
+    const int in_n = net->widths[0];
+    const int out_n = net->widths[net->n_layers];
+    double error = 0;
+
+    initializeWeights(net, m->seed);
+
+    for (int e = 0; e < Epochs; e++)
+    {
+        for (int s = 0; s < Samples; s += MiniBatch)
+        {
+            activateNNBatch(net, m->ws, m->in + (size_t)s * in_n, MiniBatch);
+            trainNNBatch(net, m->ws, m->target + (size_t)s * out_n, MiniBatch);
+        }
+    }
+
+    for (int s = 0; s < Samples; s += MiniBatch)
+    {
+        activateNNBatch(net, m->ws, m->in + (size_t)s * in_n, MiniBatch);
+        error += calcErrorBatch(net, m->ws, m->target + (size_t)s * out_n, MiniBatch) * MiniBatch / Samples;
+    }
+
+    m->error = error;
+}
+
+// Helper Function Run by Each Thread, Training Its Share of the Models
+static void *trainShare(void *arg)
+{
+    Share *share = arg;
+
+    for (int k = share->first; k < Models; k += share->step)
+        trainModel(&share->models[k]);
+
+    return NULL;
+}
+
+// Driver Function, Optional Argument is the Largest Thread Count to Try
+int main(int argc, char *argv[])
+{
+    int widths[MaxLayers];
+    int n_widths = parseTopology(Topology, widths, MaxLayers);
+    int max_threads = (argc > 1) ? atoi(argv[1]) : 8;
+    Model *models = NULL;
+    double reference[Models];
+
+    if (max_threads < 1 || posix_memalign((void **)&models, CacheLine, Models * sizeof(Model)) != 0)
+    {
+        fprintf(stderr, "Failed to Allocate Benchmark!\n");
+        return 1;
+    }
+
+    for (int k = 0; k < Models; k++)
+    {
+        if (createModel(&models[k], widths, n_widths, (uint64_t)k + 1) != 0)
+        {
+            fprintf(stderr, "Failed to Allocate Benchmark!\n");
+            return 1;
+        }
+    }
+
+    printf("%d Networks of %s, %d Samples, %d Epochs Each\n", Models, Topology, Samples, Epochs);
+    printf("%8s %12s %12s %12s %10s\n", "Threads", "Seconds", "Networks/s", "Mean Error", "Results");
+
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        pthread_t tid[threads];
+        Share shares[threads];
+
+        double start = now();
+
+        for (int t = 0; t < threads; t++)
+        {
+            shares[t] = (Share){ models, t, threads };
+            pthread_create(&tid[t], NULL, trainShare, &shares[t]);
+        }
+
+        for (int t = 0; t < threads; t++)
+            pthread_join(tid[t], NULL);
+
+        double elapsed = now() - start;
+
+        // Each Model's Result Must Not Depend on Which Thread Trained It or What Ran Beside It
+
+        double mean = 0;
+        int same = 1;
+
+        for (int k = 0; k < Models; k++)
+        {
+            if (threads == 1)
+                reference[k] = models[k].error;
+
+            same = same && memcmp(&reference[k], &models[k].error, sizeof(double)) == 0;
+            mean += models[k].error / Models;
+        }
+
+        printf("%8d %12.4f %12.1f %12.4e %10s\n", threads, elapsed, Models / elapsed, mean, same ? "identical" : "DIFFER");
+    }
+
+    for (int k = 0; k < Models; k++)
+    {
+        free(models[k].in);
+        free(models[k].target);
+        freeWorkspace(models[k].ws);
+        freeNN(models[k].net);
+    }
+    free(models);
+
+    return 0;
+}
@@ -0,0 +1,120 @@
+// ********************************************************************************
+// Micro-Benchmark of the Sigmoid Accuracy Tiers Against sigmoid()
+// ********************************************************************************
+
+#define _POSIX_C_SOURCE 199309L
+
+// Include Libraries
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "sigmoid.h"
+
+// Definitions - Macros
+#define LayerN 1024             // Values per Call, a Large Hidden Layer
+#define Reps 20000              // Calls per Timing
+#define Trials 5                // Best of This Many Timings is Reported
+#define ErrorN 4000001          // Points in the Accuracy Sweep
+#define ErrorRange 40.0         // Sweep Covers [-ErrorRange, ErrorRange]
+
+// Helper Function to Get Monotonic Time in Seconds
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+// Helper Function to Time the Scalar Reference Loop
+static double timeReference(const double *D, double *O)
+{
+    double best = 1e30;
+
+    for (int t = 0; t < Trials; t++)
+    {
+        double t0 = now();
+        for (int r = 0; r < Reps; r++)
+            for (int i = 0; i < LayerN; i++)
+                O[i] = sigmoid(D[i]);
+        double elapsed = now() - t0;
+
+        if (elapsed < best)
+            best = elapsed;
+    }
+
+    return best;
+}
+
+// Helper Function to Time One Tier
+static double timeTier(SigmoidTier tier, const double *D, double *O)
+{
+    double best = 1e30;
+
+    for (int t = 0; t < Trials; t++)
+    {
+        double t0 = now();
+        for (int r = 0; r < Reps; r++)
+            sigmoidLayer(tier, D, O, LayerN);
+        double elapsed = now() - t0;
+
+        if (elapsed < best)
+            best = elapsed;
+    }
+
+    return best;
+}
+
+// Driver Function
+int main(void)
+{
+    double *D = malloc(LayerN * sizeof(double));
+    double *O = malloc(LayerN * sizeof(double));
+    double *sweep = malloc(ErrorN * sizeof(double));
+    double *sweep_out = malloc(ErrorN * sizeof(double));
+
+    if (D == NULL || O == NULL || sweep == NULL || sweep_out == NULL)
+    {
+        fprintf(stderr, "Failed to Allocate Buffers!\n");
+        return 1;
+    }
+
+    // Typical Pre-Activation Values of a Trained Layer
+    srand(1);
+    for (int i = 0; i < LayerN; i++)
+        D[i] = ((double)rand() / RAND_MAX - 0.5) * 16.0;
+
+    for (int i = 0; i < ErrorN; i++)
+        sweep[i] = -ErrorRange + 2.0 * ErrorRange * i / (ErrorN - 1);
+
+    double reference = timeReference(D, O);
+    double values = (double)LayerN * Reps;
+
+    printf("%-10s %14s %10s %14s\n", "Tier", "MValues/s", "Speedup", "Max Error");
+    printf("%-10s %14.1f %10.2f %14s\n", "sigmoid()", values / reference * 1e-6, 1.0, "-");
+
+    for (int t = 0; t < SigmoidTiers; t++)
+    {
+        double elapsed = timeTier((SigmoidTier)t, D, O);
+        double max_error = 0.0;
+
+        sigmoidLayer((SigmoidTier)t, sweep, sweep_out, ErrorN);
+        for (int i = 0; i < ErrorN; i++)
+        {
+            double e = fabs(sweep_out[i] - sigmoid(sweep[i]));
+            if (e > max_error)
+                max_error = e;
+        }
+
+        printf("%-10s %14.1f %10.2f %14.3e\n", sigmoidTierName((SigmoidTier)t),
+               values / elapsed * 1e-6, reference / elapsed, max_error);
+    }
+
+    free(D);
+    free(O);
+    free(sweep);
+    free(sweep_out);
+
+    return 0;
+}
@@ -0,0 +1,507 @@
+// ********************************************************************************
+// Micro and Macro Benchmark Suite with JSON Results for Tracking Regressions
+// ********************************************************************************
+
+#define _POSIX_C_SOURCE 200809L
+
+// Include Libraries
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <omp.h>
+
+#include "network.h"
+#include "rng.h"
+#include "bench_fixture.h"
+
+// Definitions - Macros
+#define MaxResults 256
+#define MaxCounters 4
+#define MaxIterations 1000000000L       // Upper Bound of a Micro-Benchmark's Iteration Count
+#define DefaultMinTime 0.2              // Seconds Each Micro-Benchmark Runs For at Least
+#define MicroBatch 32                   // Samples per Call of the Batched Micro-Benchmarks
+#define MicroRate 1e-6                  // Small Enough That Repeated Training Never Diverges
+#define MacroTopology "12,128,128,10"  // Middle Layer is Big Enough for the Team to Split
+#define MacroSamples 256                // Training Set Size of the Macro-Benchmarks
+#define MacroStep 32                    // Samples per Step of the Batched and Data-Parallel Modes
+
+const int grid[] = { 16, 64, 256, 1024 };   // Layer Widths of the Micro-Benchmarks, N,N,N Networks
+
+// One Benchmark Run, Named and Laid Out as Google Benchmark Reports It
+typedef struct
+{
+    char name[96];
+    long iterations;
+    double real_time;           // Per Iteration, in time_unit
+    double cpu_time;
+    const char *time_unit;
+    int n_counters;
+    const char *counter_names[MaxCounters];
+    double counters[MaxCounters];
+} Result;
+
+// Settings and Results of a Whole Run
+typedef struct
+{
+    const char *filter;         // Only Benchmarks Whose Name Contains This Run, NULL for All
+    double min_time;
+    int threads;                // Team Size of the OpenMP Macro-Benchmarks
+    Precision precision;        // Of the Networks in the Micro-Benchmarks
+    int quiet;                  // No Table on stdout, the JSON Goes There Instead
+    Result results[MaxResults];
+    int n_results;
+} Suite;
+
+// A Micro-Benchmark Body, Running iterations Calls of the Code Under Test
+typedef void (*BenchBody)(void *ctx, long iterations);
+
+// Code Under Test and Its Arguments
+typedef struct
+{
+    SigmoidTier tier;
+    const double *D;
+    double *O;
+    int n;
+} SigmoidCase;
+
+typedef struct
+{
+    Network *net;
+    Workspace *ws;
+    const double *in;           // [MicroBatch][in_n]
+    const double *target;       // [MicroBatch][out_n]
+    double sink;                // Keeps Results Live
+} NetworkCase;
+
+// Names of the Training Modes in Macro-Benchmark Results
+static const char *const macro_names[TrainModes] = { "serial", "serial_batch", "omp_team", "omp_data", "omp_hogwild" };
+
+// ***********************************
+// Helper Functions
+// ***********************************
+
+// Helper Function to Get Monotonic Time in Seconds
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+// Helper Function to Get the CPU Time of the Process in Seconds, All Threads Included
+static double cpuNow(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+// Helper Function to Check Whether a Benchmark Passes the Filter
+static int wanted(const Suite *suite, const char *name)
+{
+    return suite->filter == NULL || strstr(name, suite->filter) != NULL;
+}
+
+// Helper Function to Record a Result, Returns NULL When the Table is Full
+static Result *addResult(Suite *suite, const char *name, long iterations, double real_time, double cpu_time, const char *time_unit)
+{
+    if (suite->n_results == MaxResults)
+        return NULL;
+
+    Result *r = &suite->results[suite->n_results++];
+
+    memset(r, 0, sizeof(*r));
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->iterations = iterations;
+    r->real_time = real_time;
+    r->cpu_time = cpu_time;
+    r->time_unit = time_unit;
+
+    return r;
+}
+
+// Helper Function to Attach a Named Counter to a Result
+static void addCounter(Result *r, const char *name, double value)
+{
+    if (r != NULL && r->n_counters < MaxCounters)
+    {
+        r->counter_names[r->n_counters] = name;
+        r->counters[r->n_counters++] = value;
+    }
+}
+
+// Helper Function to Print a Result as a Console Table Row
+static void printResult(const Suite *suite, const Result *r)
+{
+    if (suite->quiet || r == NULL)
+        return;
+
+    printf("%-48s %14.4g %-2s %14.4g %-2s %12ld", r->name, r->real_time, r->time_unit, r->cpu_time, r->time_unit, r->iterations);
+    for (int c = 0; c < r->n_counters; c++)
+        printf(" %s=%.4g", r->counter_names[c], r->counters[c]);
+    printf("\n");
+    fflush(stdout);
+}
+
+// Helper Function to Run a Micro-Benchmark Until It Takes min_time, Google Benchmark Style
+// Each Attempt Sizes the Next from Its Own Time, Growing at Most Tenfold, and the Last is Reported
+static void runMicro(Suite *suite, const char *name, BenchBody body, void *ctx, double items)
+{
+    if (!wanted(suite, name))
+        return;
+
+    body(ctx, 1);           // Warm Caches and Page in Buffers
+
+    long iterations = 1;
+    double real, cpu;
+
+    for (;;)
+    {
+        const double r0 = now(), c0 = cpuNow();
+        body(ctx, iterations);
+        real = now() - r0;
+        cpu = cpuNow() - c0;
+
+        if (real >= suite->min_time || iterations >= MaxIterations)
+            break;
+
+        double grow = (real > 0) ? 1.4 * suite->min_time / real : 10.0;
+        grow = (grow > 10.0) ? 10.0 : ((grow < 2.0) ? 2.0 : grow);
+        iterations = (long)(iterations * grow);
+    }
+
+    Result *r = addResult(suite, name, iterations, real / iterations * 1e9, cpu / iterations * 1e9, "ns");
+    addCounter(r, "items_per_second", items * iterations / real);
+    printResult(suite, r);
+}
+
+// Helper Function to Write the Results as Google Benchmark JSON
+static int writeJson(const Suite *suite, FILE *f)
+{
+    char host[256] = "unknown";
+    char date[64];
+    time_t t = time(NULL);
+    struct tm tm;
+
+    gethostname(host, sizeof(host) - 1);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime_r(&t, &tm));
+
+    fprintf(f, "{\n  \"context\": {\n");
+    fprintf(f, "    \"date\": \"%s\",\n", date);
+    fprintf(f, "    \"host_name\": \"%s\",\n", host);
+    fprintf(f, "    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(f, "    \"omp_threads\": %d,\n", suite->threads);
+    fprintf(f, "    \"simd\": \"%s\",\n", simdKernels()->name);
+    fprintf(f, "    \"precision\": \"%s\",\n", precisionName(suite->precision));
+#ifdef NDEBUG
+    fprintf(f, "    \"library_build_type\": \"release\"\n");
+#else
+    fprintf(f, "    \"library_build_type\": \"debug\"\n");
+#endif
+    fprintf(f, "  },\n  \"benchmarks\": [\n");
+
+    for (int i = 0; i < suite->n_results; i++)
+    {
+        const Result *r = &suite->results[i];
+
+        fprintf(f, "    {\n      \"name\": \"%s\",\n      \"run_name\": \"%s\",\n      \"run_type\": \"iteration\",\n", r->name, r->name);
+        fprintf(f, "      \"iterations\": %ld,\n      \"real_time\": %.17g,\n      \"cpu_time\": %.17g,\n      \"time_unit\": \"%s\"",
+                r->iterations, r->real_time, r->cpu_time, r->time_unit);
+        for (int c = 0; c < r->n_counters; c++)
+            fprintf(f, ",\n      \"%s\": %.17g", r->counter_names[c], r->counters[c]);
+        fprintf(f, "\n    }%s\n", (i + 1 < suite->n_results) ? "," : "");
+    }
+
+    fprintf(f, "  ]\n}\n");
+
+    return ferror(f) ? -1 : 0;
+}
+
+// ***********************************
+// Micro-Benchmarks
+// ***********************************
+
+static void benchSigmoid(void *ctx, long iterations)
+{
+    SigmoidCase *c = ctx;
+
+    for (long i = 0; i < iterations; i++)
+        sigmoidLayer(c->tier, c->D, c->O, c->n);
+}
+
+static void benchActivate(void *ctx, long iterations)
+{
+    NetworkCase *c = ctx;
+
+    for (long i = 0; i < iterations; i++)
+        activateNN(c->net, c->ws, c->in);
+}
+
+static void benchTrain(void *ctx, long iterations)
+{
+    NetworkCase *c = ctx;
+
+    for (long i = 0; i < iterations; i++)
+        trainNN(c->net, c->ws, c->target);
+}
+
+static void benchCalcError(void *ctx, long iterations)
+{
+    NetworkCase *c = ctx;
+
+    for (long i = 0; i < iterations; i++)
+        c->sink += calcError(c->net, c->ws, c->target);
+}
+
+static void benchActivateBatch(void *ctx, long iterations)
+{
+    NetworkCase *c = ctx;
+
+    for (long i = 0; i < iterations; i++)
+        activateNNBatch(c->net, c->ws, c->in, MicroBatch);
+}
+
+static void benchTrainBatch(void *ctx, long iterations)
+{
+    NetworkCase *c = ctx;
+
+    for (long i = 0; i < iterations; i++)
+        trainNNBatch(c->net, c->ws, c->target, MicroBatch);
+}
+
+// Function to Run the Sigmoid Micro-Benchmarks, Every Tier at Every Grid Width
+static void runSigmoid(Suite *suite)
+{
+    const int n = grid[sizeof(grid) / sizeof(grid[0]) - 1];
+    double *D = malloc(n * sizeof(double));
+    double *O = malloc(n * sizeof(double));
+
+    if (D == NULL || O == NULL)
+    {
+        fprintf(stderr, "Failed to Allocate Benchmark!\n");
+        exit(1);
+    }
+
+    // Typical Pre-Activation Values of a Trained Layer
+    for (int i = 0; i < n; i++)
+        D[i] = (rngUniform(1, RngInputs, i) - 0.5) * 16.0;
+
+    for (int t = 0; t < SigmoidTiers; t++)
+    {
+        for (size_t g = 0; g < sizeof(grid) / sizeof(grid[0]); g++)
+        {
+            char name[96];
+            SigmoidCase c = { (SigmoidTier)t, D, O, grid[g] };
+
+            snprintf(name, sizeof(name), "BM_Sigmoid/%s/%d", sigmoidTierName((SigmoidTier)t), grid[g]);
+            runMicro(suite, name, benchSigmoid, &c, grid[g]);
+        }
+    }
+
+    free(D);
+    free(O);
+}
+
+// Function to Run the Network Micro-Benchmarks over the Grid of N,N,N Networks
+static void runNetwork(Suite *suite)
+{
+    for (size_t g = 0; g < sizeof(grid) / sizeof(grid[0]); g++)
+    {
+        const int n = grid[g];
+        const int widths[3] = { n, n, n };
+        Network *net = createNN(widths, 3, MicroRate, suite->precision);
+        Workspace *ws = (net != NULL) ? createWorkspace(net, MicroBatch) : NULL;
+        double *in = malloc((size_t)MicroBatch * n * sizeof(double));
+        double *target = malloc((size_t)MicroBatch * n * sizeof(double));
+
+        if (ws == NULL || in == NULL || target == NULL)
+        {
+            fprintf(stderr, "Failed to Allocate Benchmark!\n");
+            exit(1);
+        }
+
+        initializeWeights(net, 1);
+        for (size_t i = 0; i < (size_t)MicroBatch * n; i++)
+        {
+            in[i] = rngUniform(1, RngInputs, i) - 0.5;
+            target[i] = rngUniform(1, RngOutputs, i);
+        }
+
+        NetworkCase c = { net, ws, in, target, 0.0 };
+        char name[96];
+
+        // Single Sample Passes, trainNN and calcError Reusing the Activation Taken Here
+        snprintf(name, sizeof(name), "BM_ActivateNN/%d", n);
+        runMicro(suite, name, benchActivate, &c, 1);
+
+        activateNN(net, ws, in);
+
+        snprintf(name, sizeof(name), "BM_CalcError/%d", n);
+        runMicro(suite, name, benchCalcError, &c, 1);
+
+        snprintf(name, sizeof(name), "BM_TrainNN/%d", n);
+        runMicro(suite, name, benchTrain, &c, 1);
+
+        // Batched Passes, Items Being Samples
+        snprintf(name, sizeof(name), "BM_ActivateNNBatch/%d/%d", n, MicroBatch);
+        runMicro(suite, name, benchActivateBatch, &c, MicroBatch);
+
+        activateNNBatch(net, ws, in, MicroBatch);
+
+        snprintf(name, sizeof(name), "BM_TrainNNBatch/%d/%d", n, MicroBatch);
+        runMicro(suite, name, benchTrainBatch, &c, MicroBatch);
+
+        free(in);
+        free(target);
+        freeWorkspace(ws);
+        freeNN(net);
+    }
+}
+
+// ***********************************
+// Macro-Benchmarks
+// ***********************************
+
+// Function to Run the Macro-Benchmarks, Every Mode from the Same Weights on the Same Data
+// Targets Are the Outputs of a Random Teacher Network, so FixtureMaxError is Reachable
+// The Team Mode is Skipped for a Topology Whose Layers Are Too Small for the Team to Split,
+// Since It Would Only Time the Serial Pass Under a Threaded Name
+static void runMacro(Suite *suite)
+{
+    int widths[MaxLayers];
+    const int n_widths = parseTopology(MacroTopology, widths, MaxLayers);
+    const int in_n = widths[0];
+    const int out_n = widths[n_widths - 1];
+
+    Network *net = createNN(widths, n_widths, FixtureRate, PrecisionDouble);
+    double *init = malloc((net != NULL ? net->n_weights : 0) * sizeof(double));
+    double *in = malloc((size_t)MacroSamples * in_n * sizeof(double));
+    double *target = malloc((size_t)MacroSamples * out_n * sizeof(double));
+
+    if (net == NULL || init == NULL || in == NULL || target == NULL ||
+        teacherData(widths, n_widths, 1, MacroSamples, in, target) != 0)
+    {
+        fprintf(stderr, "Failed to Allocate Benchmark!\n");
+        exit(1);
+    }
+
+    randomWeights(net, 2, 0.25);
+    memcpy(init, net->weights, net->n_weights * sizeof(double));
+
+    for (int m = 0; m < TrainModes; m++)
+    {
+        const int threads = (m >= TrainTeam) ? suite->threads : 1;
+        char name[96];
+
+        snprintf(name, sizeof(name), "BM_TimeToError/%s/%s/threads:%d", MacroTopology, macro_names[m], threads);
+        if (!wanted(suite, name))
+            continue;
+
+        if (m == TrainTeam && !teamSplitsNN(net))
+        {
+            fprintf(stderr, "Skipping %s, No Layer is Big Enough for the Team to Split\n", name);
+            continue;
+        }
+
+        int epochs;
+        double error;
+        const double c0 = cpuNow();
+        const double elapsed = trainToError(net, init, in, target, MacroSamples, MacroStep, (TrainMode)m, threads, &epochs, &error);
+        const double cpu = cpuNow() - c0;
+
+        Result *r = addResult(suite, name, 1, elapsed, cpu, "s");
+        addCounter(r, "epochs", epochs);
+        addCounter(r, "error", error);
+        addCounter(r, "converged", error <= FixtureMaxError);
+        addCounter(r, "samples_per_second", (double)epochs * MacroSamples / elapsed);
+        printResult(suite, r);
+    }
+
+    free(init);
+    free(in);
+    free(target);
+    freeNN(net);
+}
+
+// Helper Function to Print Usage
+static void printUsage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-f filter] [-m seconds] [-t threads] [-p type] [-o file] [-j]\n", name);
+    fprintf(stderr, "  -f filter   Only Run Benchmarks Whose Name Contains This\n");
+    fprintf(stderr, "  -m seconds  Least Time per Micro-Benchmark (Default %g)\n", DefaultMinTime);
+    fprintf(stderr, "  -t threads  Team Size of the OpenMP Macro-Benchmarks (Default omp_get_max_threads())\n");
+    fprintf(stderr, "  -p type     Precision of the Micro-Benchmark Networks: double, float or mixed (Default double)\n");
+    fprintf(stderr, "  -o file     Also Write the Results as JSON to file\n");
+    fprintf(stderr, "  -j          Write the JSON to stdout Instead of the Table\n");
+}
+
+// Driver Function
+int main(int argc, char *argv[])
+{
+    static Suite suite;
+    const char *json_path = NULL;
+    int opt;
+
+    suite.min_time = DefaultMinTime;
+    suite.threads = omp_get_max_threads();
+    suite.precision = PrecisionDouble;
+
+    while ((opt = getopt(argc, argv, "f:m:t:p:o:j")) != -1)
+    {
+        switch (opt)
+        {
+            case 'f':
+                suite.filter = optarg;
+                break;
+            case 'm':
+                suite.min_time = atof(optarg);
+                break;
+            case 't':
+                suite.threads = atoi(optarg);
+                break;
+            case 'p':
+                suite.precision = (Precision)parsePrecision(optarg);
+                break;
+            case 'o':
+                json_path = optarg;
+                break;
+            case 'j':
+                suite.quiet = 1;
+                break;
+            default:
+                printUsage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (suite.min_time <= 0 || suite.threads < 1 || (int)suite.precision < 0)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!suite.quiet)
+        printf("%-48s %17s %17s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+
+    runSigmoid(&suite);
+    runNetwork(&suite);
+    runMacro(&suite);
+
+    if (suite.quiet && writeJson(&suite, stdout) != 0)
+        return 1;
+
+    if (json_path != NULL)
+    {
+        FILE *f = fopen(json_path, "w");
+
+        if (f == NULL || writeJson(&suite, f) != 0 || fclose(f) != 0)
+        {
+            fprintf(stderr, "Failed to Write %s!\n", json_path);
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,359 @@
+// ********************************************************************************
+// Binary Checkpoints of a Network and Its Training Progress
+// ********************************************************************************
+
+#define _POSIX_C_SOURCE 200809L
+
+// Include Libraries
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "checkpoint.h"
+
+// Definitions - Macros
+#define AlignUp(n) ((((n) + CheckpointAlign - 1) / CheckpointAlign) * CheckpointAlign)
+#define HashBasis 0xcbf29ce484222325ULL     // FNV-1a 64-Bit Offset Basis
+#define HashPrime 0x100000001b3ULL          // FNV-1a 64-Bit Prime
+
+// ***********************************
+// Helper Functions
+// ***********************************
+
+// Helper Function to Get Monotonic Time in Seconds
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+// Helper Function to Hash an Arena, FNV-1a over 64-Bit Words (Arenas Are Whole Cache Lines)
+static uint64_t hashArena(const void *arena, size_t bytes)
+{
+    const uint64_t *w = arena;
+    uint64_t h = HashBasis;
+
+    for (size_t i = 0; i < bytes / sizeof(uint64_t); i++)
+        h = (h ^ w[i]) * HashPrime;
+
+    return h;
+}
+
+// Helper Function to Get the Arena of a Network and Its Size in Bytes
+static const void *arenaOf(const Network *net, size_t *bytes)
+{
+    if (net->weights != NULL)
+    {
+        *bytes = net->n_weights * sizeof(double);
+        return net->weights;
+    }
+
+    *bytes = net->n_weights * sizeof(float);
+    return net->weights_f;
+}
+
+// Helper Function to Flush the Directory Holding path, so a Rename Into It Survives a Crash
+static int syncDirectory(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+    char *dir = (slash == NULL) ? strdup(".") : strndup(path, (slash == path) ? 1 : (size_t)(slash - path));
+
+    if (dir == NULL)
+        return -1;
+
+    int fd = open(dir, O_RDONLY);
+    int ok = (fd >= 0) && fsync(fd) == 0;
+
+    if (fd >= 0)
+        close(fd);
+    free(dir);
+
+    return ok ? 0 : -1;
+}
+
+// Helper Function to Build a Network from a Mapped Checkpoint Image
+static Network *networkFromImage(const void *map, size_t map_bytes, TrainState *state)
+{
+    const CheckpointHeader *h = map;
+    int widths[MaxLayers];
+
+    if (memcmp(h->magic, CheckpointMagic, sizeof(h->magic)) != 0 || h->version != CheckpointVersion ||
+        h->n_layers < 1 || h->n_layers >= MaxLayers || h->precision >= Precisions || h->sigmoid_tier >= SigmoidTiers)
+        return NULL;
+
+    for (uint32_t l = 0; l <= h->n_layers; l++)
+    {
+        if (h->widths[l] < 1 || h->widths[l] > INT32_MAX)
+            return NULL;
+
+        widths[l] = (int)h->widths[l];
+    }
+
+    // The Arena the Header's Shape Needs is Checked Against the File Before Anything is Allocated,
+    // so a Corrupt Header Cannot Ask for More Memory Than the Checkpoint Holds
+    const size_t element = (h->precision == PrecisionDouble) ? sizeof(double) : sizeof(float);
+    const size_t bytes = networkBytes(widths, (int)h->n_layers + 1, (Precision)h->precision);
+
+    if (bytes == 0 || bytes / element != h->n_weights || h->weights_offset % CheckpointAlign != 0 ||
+        h->weights_offset > map_bytes || map_bytes - h->weights_offset < bytes)
+        return NULL;
+
+    const char *image = (const char *)map + h->weights_offset;
+
+    if (hashArena(image, bytes) != h->checksum)
+        return NULL;
+
+    Network *net = createNN(widths, (int)h->n_layers + 1, h->learn_rate, (Precision)h->precision);
+    if (net == NULL)
+        return NULL;
+
+    size_t arena_bytes;
+    void *arena = (void *)arenaOf(net, &arena_bytes);
+
+    memcpy(arena, image, arena_bytes);
+    net->sigmoid_tier = (SigmoidTier)h->sigmoid_tier;
+
+    if (state != NULL)
+    {
+        state->epoch = h->epoch;
+        state->seed = h->seed;
+        state->error = h->error;
+    }
+
+    return net;
+}
+
+// Helper Function to Write a Checkpoint of net's Shape with the Weights in arena, Atomically
+// The Image Goes to path.tmp and is Synced Before It is Renamed Over path
+static int writeImage(const char *path, const Network *net, const void *arena, size_t bytes, const TrainState *state)
+{
+    CheckpointHeader h;
+
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, CheckpointMagic, sizeof(h.magic));
+    h.version = CheckpointVersion;
+    h.n_layers = (uint32_t)net->n_layers;
+    h.precision = (uint32_t)net->precision;
+    for (int l = 0; l <= net->n_layers; l++)
+        h.widths[l] = (uint32_t)net->widths[l];
+    h.sigmoid_tier = (uint32_t)net->sigmoid_tier;
+    h.learn_rate = net->learn_rate;
+    h.epoch = state->epoch;
+    h.seed = state->seed;
+    h.error = state->error;
+    h.n_weights = net->n_weights;
+    h.weights_offset = AlignUp(sizeof(h));
+    h.checksum = hashArena(arena, bytes);
+
+    char *tmp = malloc(strlen(path) + sizeof(".tmp"));
+    if (tmp == NULL)
+        return -1;
+
+    sprintf(tmp, "%s.tmp", path);
+
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    int ok = (fd >= 0) &&
+             pwrite(fd, &h, sizeof(h), 0) == (ssize_t)sizeof(h) &&
+             pwrite(fd, arena, bytes, (off_t)h.weights_offset) == (ssize_t)bytes &&
+             fsync(fd) == 0;
+
+    if (fd >= 0)
+        ok = (close(fd) == 0) && ok;
+
+    ok = ok && rename(tmp, path) == 0 && syncDirectory(path) == 0;
+
+    if (!ok)
+        unlink(tmp);
+    free(tmp);
+
+    return ok ? 0 : -1;
+}
+
+// Helper Function Run by the Checkpoint Writer Thread
+static void *writeCheckpoints(void *arg)
+{
+    Checkpointer *cp = arg;
+
+    pthread_mutex_lock(&cp->lock);
+
+    for (;;)
+    {
+        while (!cp->pending && !cp->stop)
+            pthread_cond_wait(&cp->cond, &cp->lock);
+
+        if (!cp->pending)           // Stopped with Nothing Left to Write
+            break;
+
+        pthread_mutex_unlock(&cp->lock);
+
+        double start = now();
+        int failed = writeImage(cp->path, cp->net, cp->spare, cp->bytes, &cp->state);
+        double elapsed = now() - start;
+
+        pthread_mutex_lock(&cp->lock);
+        cp->write += elapsed;
+        cp->written += !failed;
+        cp->failed += (failed != 0);
+        cp->pending = 0;
+    }
+
+    pthread_mutex_unlock(&cp->lock);
+
+    return NULL;
+}
+
+// ***********************************
+// Checkpoint Interface
+// ***********************************
+
+// Function to Write a Checkpoint Atomically, Returns 0 on Success
+int saveCheckpoint(const char *path, const Network *net, const TrainState *state)
+{
+    size_t bytes;
+    const void *arena = arenaOf(net, &bytes);
+
+    return writeImage(path, net, arena, bytes, state);
+}
+
+// Function to Create a Network from a Checkpoint
+// The File is Mapped, so Loading is One Header Check and One Copy of the Arena
+Network *loadCheckpoint(const char *path, TrainState *state)
+{
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+        return NULL;
+
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CheckpointHeader))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    const size_t map_bytes = (size_t)st.st_size;
+    void *map = mmap(NULL, map_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    close(fd);          // The Mapping Keeps the File Open
+
+    if (map == MAP_FAILED)
+        return NULL;
+
+    Network *net = networkFromImage(map, map_bytes, state);
+
+    munmap(map, map_bytes);
+
+    return net;
+}
+
+// Function to Create a Background Checkpointer and Start Its Writer Thread
+// The Spare Arena is Allocated Once Here, Snapshots Only Copy into It
+Checkpointer *createCheckpointer(const char *path, const Network *net, int every_epochs, double every_seconds)
+{
+    Checkpointer *cp = calloc(1, sizeof(Checkpointer));
+    if (cp == NULL)
+        return NULL;
+
+    arenaOf(net, &cp->bytes);
+
+    cp->net = net;
+    cp->path = strdup(path);
+    cp->every_epochs = every_epochs;
+    cp->every_seconds = every_seconds;
+    cp->last = now();
+
+    if (posix_memalign(&cp->spare, CheckpointAlign, cp->bytes) != 0)
+        cp->spare = NULL;
+
+    pthread_mutex_init(&cp->lock, NULL);
+    pthread_cond_init(&cp->cond, NULL);
+
+    if (cp->path == NULL || cp->spare == NULL || pthread_create(&cp->thread, NULL, writeCheckpoints, cp) != 0)
+    {
+        pthread_cond_destroy(&cp->cond);
+        pthread_mutex_destroy(&cp->lock);
+        free(cp->spare);
+        free(cp->path);
+        free(cp);
+        return NULL;
+    }
+
+    return cp;
+}
+
+// Function to Let a Write in Flight Finish and Stop the Writer, After Which the Counts Are Final
+void stopCheckpointer(Checkpointer *cp)
+{
+    if (cp->joined)
+        return;
+
+    pthread_mutex_lock(&cp->lock);
+    cp->stop = 1;
+    pthread_cond_signal(&cp->cond);
+    pthread_mutex_unlock(&cp->lock);
+
+    pthread_join(cp->thread, NULL);
+    cp->joined = 1;
+}
+
+// Function to Stop the Writer and Release the Checkpointer
+void freeCheckpointer(Checkpointer *cp)
+{
+    if (cp == NULL)
+        return;
+
+    stopCheckpointer(cp);
+
+    pthread_cond_destroy(&cp->cond);
+    pthread_mutex_destroy(&cp->lock);
+    free(cp->spare);
+    free(cp->path);
+    free(cp);
+}
+
+// Function to Snapshot the Weights if a Checkpoint is Due, Called Between Epochs
+// The Snapshot is One memcpy of the Arena, Hashing and Writing Happen on the Writer Thread
+int tickCheckpointer(Checkpointer *cp, const TrainState *state)
+{
+    const double start = now();
+
+    if (!((cp->every_epochs > 0 && state->epoch % cp->every_epochs == 0) ||
+          (cp->every_seconds > 0 && start - cp->last >= cp->every_seconds)))
+        return 0;
+
+    pthread_mutex_lock(&cp->lock);
+    const int busy = cp->pending;
+    pthread_mutex_unlock(&cp->lock);
+
+    if (busy)
+    {
+        cp->skipped++;
+        return 0;
+    }
+
+    size_t bytes;
+    const void *arena = arenaOf(cp->net, &bytes);
+
+    memcpy(cp->spare, arena, bytes);
+
+    pthread_mutex_lock(&cp->lock);
+    cp->state = *state;
+    cp->pending = 1;
+    pthread_cond_signal(&cp->cond);
+    pthread_mutex_unlock(&cp->lock);
+
+    const double elapsed = now() - start;
+
+    cp->last = start;
+    cp->taken++;
+    cp->stall += elapsed;
+    cp->stall_max = (elapsed > cp->stall_max) ? elapsed : cp->stall_max;
+
+    return 1;
+}
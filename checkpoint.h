@@ -0,0 +1,96 @@
+// ********************************************************************************
+// Binary Checkpoints of a Network and Its Training Progress
+// ********************************************************************************
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "network.h"
+
+// Definitions - Macros
+#define CheckpointMagic "EBPC"          // First Bytes of a Checkpoint
+#define CheckpointVersion 1             // Bumped Whenever the Layout Below Changes
+#define CheckpointAlign 4096            // The Weight Arena Starts on a Page Boundary
+
+// Training Progress Saved Alongside the Weights
+// Every Random Stream is Philox Keyed by seed and Indexed by Position or Epoch,
+// so seed and epoch Are the Whole Generator State
+typedef struct
+{
+    uint64_t epoch;             // Epochs Completed
+    uint64_t seed;              // Seed of Data, Weights and Sample Order
+    double error;               // Error of the Last Completed Epoch
+} TrainState;
+
+// Header of a Checkpoint, Followed at weights_offset by the Weight Arena Exactly as in Memory
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t n_layers;
+    uint32_t precision;         // Precision, Also the Type of the Arena (double or float)
+    uint32_t widths[MaxLayers];
+    uint32_t sigmoid_tier;
+    uint32_t reserved;
+    double learn_rate;          // Plain SGD, the Rate is All the Optimizer State There Is
+    uint64_t epoch;
+    uint64_t seed;
+    double error;
+    uint64_t n_weights;         // Weights in the Arena, Padding Included
+    uint64_t weights_offset;    // File Offset of the Arena, a Multiple of CheckpointAlign
+    uint64_t checksum;          // Hash of the Arena Bytes, Checked on Load
+} CheckpointHeader;
+
+// Periodic Checkpoints Written by a Background Thread from a Snapshot of the Weights
+// The Training Thread Only Pays for Copying the Arena into the Spare Buffer
+typedef struct
+{
+    const Network *net;         // Network Being Trained, Its Shape Never Changes
+    char *path;
+    int every_epochs;           // Snapshot Every This Many Epochs, 0 for Never
+    double every_seconds;       // Or When This Long Has Passed Since the Last, 0 for Never
+    double last;                // Time of the Last Snapshot
+    void *spare;                // Arena-Sized Buffer the Snapshot is Copied Into
+    size_t bytes;
+    TrainState state;           // Progress at the Snapshot
+    int pending;                // Set While the Writer Owns spare
+    int stop;
+    int joined;                 // Set Once the Writer Has Exited
+
+    // Cost Accounting
+    int taken;                  // Snapshots Handed to the Writer
+    int skipped;                // Due While the Previous Write Was Still in Flight
+    int written;                // Checkpoints That Reached the Disk
+    int failed;                 // Writes That Did Not
+    double stall;               // Seconds the Training Thread Spent Taking Snapshots
+    double stall_max;           // Longest Single Snapshot
+    double write;               // Seconds the Writer Spent Writing and Syncing
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} Checkpointer;
+
+// Function to Write a Checkpoint Atomically, Returns 0 on Success
+// A Reader Sees Either the Previous File or the Complete New One, Never a Partial Write
+int saveCheckpoint(const char *path, const Network *net, const TrainState *state);
+
+// Function to Create a Network from a Checkpoint, with Its Saved Topology, Precision, Rate and Tier
+// Fills state (if Not NULL), Returns NULL if the File is Missing, Foreign or Corrupt
+Network *loadCheckpoint(const char *path, TrainState *state);
+
+// Construction and Destruction of a Background Checkpointer
+Checkpointer *createCheckpointer(const char *path, const Network *net, int every_epochs, double every_seconds);
+void freeCheckpointer(Checkpointer *cp);
+
+// Function to Let a Write in Flight Finish and Stop the Writer, After Which the Counts Are Final
+void stopCheckpointer(Checkpointer *cp);
+
+// Function to Snapshot the Weights if a Checkpoint is Due, Called Between Epochs
+// Never Waits for the Disk, a Checkpoint Due While the Last is Still Being Written is Skipped
+// Returns 1 if a Snapshot Was Taken, 0 Otherwise
+int tickCheckpointer(Checkpointer *cp, const TrainState *state);
+
+#endif
@@ -0,0 +1,137 @@
+// ********************************************************************************
+// Converter of CSV (or Binary) Datasets to the Binary Dataset Format
+// ********************************************************************************
+
+#define _POSIX_C_SOURCE 200809L
+
+// Include Libraries
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dataset.h"
+
+// Helper Function to Get Monotonic Time in Seconds
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+// Helper Function to Print Usage
+static void printUsage(const char *name)
+{
+    fprintf(stderr, "Usage: %s -i inputs -o targets [-t type] source output\n", name);
+    fprintf(stderr, "  -i inputs   Inputs per Sample, Leading Values of a CSV Row\n");
+    fprintf(stderr, "  -o targets  Targets per Sample, Trailing Values of a CSV Row\n");
+    fprintf(stderr, "  -t type     Value Type Written: double or float32 (Default double)\n");
+    fprintf(stderr, "  source      CSV File, or a Binary Dataset to Rewrite as Another Type\n");
+}
+
+// Driver Function
+// One Pass Counts the Samples so the Blocks Can Be Laid Out, a Second Streams Them Across,
+// so Memory Stays at One Chunk However Large the Source
+int main(int argc, char *argv[])
+{
+    int in_n = 0;
+    int out_n = 0;
+    int type = DatasetDouble;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:o:t:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'i':
+                in_n = atoi(optarg);
+                break;
+            case 'o':
+                out_n = atoi(optarg);
+                break;
+            case 't':
+                type = parseDatasetType(optarg);
+                break;
+            default:
+                printUsage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (argc - optind != 2 || in_n < 0 || out_n < 0 || type < 0)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const char *source = argv[optind];
+    const char *output = argv[optind + 1];
+    const double *in, *target;
+    size_t rows;
+
+    double start = now();
+
+    Dataset *ds = openDataset(source, in_n, out_n, DefaultChunk);
+    if (ds == NULL)
+    {
+        fprintf(stderr, "Failed to Open Dataset %s with %d Inputs and %d Targets!\n", source, in_n, out_n);
+        return 1;
+    }
+
+    // Count Samples, a Binary Source Already Knows
+
+    if (ds->format == DatasetCsv)
+    {
+        while (readChunk(ds, &in, &target) > 0)
+            ;
+
+        if (ds->error)
+            return 1;
+
+        rewindDataset(ds);
+    }
+
+    // Stream Samples Across
+
+    DatasetWriter *w = createDatasetWriter(output, ds->in_n, ds->out_n, ds->n_samples, (DatasetType)type);
+    if (w == NULL)
+    {
+        fprintf(stderr, "Failed to Create Dataset %s!\n", output);
+        return 1;
+    }
+
+    while ((rows = readChunk(ds, &in, &target)) > 0)
+    {
+        if (writeDataset(w, in, target, rows) != 0)
+            break;
+    }
+
+    if (closeDatasetWriter(w) != 0 || ds->error)
+    {
+        fprintf(stderr, "Failed to Write Dataset %s!\n", output);
+        return 1;
+    }
+
+    printf("Converted %zu Samples of %d Inputs and %d Targets to %s in %f s\n", ds->n_samples, ds->in_n, ds->out_n,
+           datasetTypeName((DatasetType)type), now() - start);
+
+    closeDataset(ds);
+
+    // Opening the Result is What a Training Run Pays Before Its First Epoch
+
+    start = now();
+    ds = openDataset(output, in_n, out_n, DefaultChunk);
+
+    if (ds == NULL)
+    {
+        fprintf(stderr, "Failed to Open Dataset %s!\n", output);
+        return 1;
+    }
+
+    printf("Opened %s in %f ms\n", output, (now() - start) * 1e3);
+
+    closeDataset(ds);
+
+    return 0;
+}
@@ -0,0 +1,423 @@
+// ********************************************************************************
+// Labeled Datasets Streamed from CSV or Memory-Mapped from Binary Files
+// ********************************************************************************
+
+#define _POSIX_C_SOURCE 200809L
+
+// Include Libraries
+#include <stdint.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "dataset.h"
+
+// Definitions - Macros
+#define CsvBuffer (1 << 20)             // stdio Buffer of a CSV File, Read Ahead in Large Blocks
+#define NarrowBlock 4096                // Values Converted per Write of a float32 Dataset
+#define AlignUp(n) ((((n) + DatasetAlign - 1) / DatasetAlign) * DatasetAlign)
+
+static const char *const type_names[DatasetTypes] = { "double", "float32" };
+static const size_t type_bytes[DatasetTypes] = { sizeof(double), sizeof(float) };
+
+// ***********************************
+// Helper Functions
+// ***********************************
+
+// Helper Function to Fill a Header and Lay Out Its Blocks
+static void layoutHeader(DatasetHeader *h, int in_n, int out_n, size_t n_samples, DatasetType type)
+{
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, DatasetMagic, sizeof(h->magic));
+    h->version = DatasetVersion;
+    h->in_n = (uint32_t)in_n;
+    h->out_n = (uint32_t)out_n;
+    h->n_samples = n_samples;
+    h->type = (uint32_t)type;
+    h->in_offset = AlignUp(sizeof(*h));
+    h->target_offset = h->in_offset + AlignUp(n_samples * in_n * type_bytes[type]);
+}
+
+// Helper Function to Get the Bytes of a Block of n_samples Rows of width Values, Returns -1 on Overflow
+// Header Fields Are Untrusted, so Each Product is Checked Before It Can Wrap
+static int blockBytes(uint64_t n_samples, uint32_t width, size_t bytes, size_t *block)
+{
+    if (n_samples > SIZE_MAX / width || (size_t)n_samples * width > SIZE_MAX / bytes)
+        return -1;
+
+    *block = (size_t)n_samples * width * bytes;
+
+    return 0;
+}
+
+// Helper Function to Map a Binary Dataset Read-Only
+// Opening Costs a Header Check Whatever the Size, Pages Fault in as Training Reaches Them,
+// and the Kernel is Told Access is Sequential, so It Reads Ahead of the Training Loop
+static int mapBinary(Dataset *ds, int fd, int in_n, int out_n)
+{
+    struct stat st;
+    DatasetHeader h;
+
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(h))
+        return -1;
+
+    ds->map_bytes = (size_t)st.st_size;
+    ds->map = mmap(NULL, ds->map_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (ds->map == MAP_FAILED)
+    {
+        ds->map = NULL;
+        return -1;
+    }
+
+    memcpy(&h, ds->map, sizeof(h));
+
+    if (h.version != DatasetVersion || h.type >= DatasetTypes || h.in_n == 0 || h.out_n == 0 ||
+        (in_n != 0 && (int)h.in_n != in_n) || (out_n != 0 && (int)h.out_n != out_n))
+        return -1;
+
+    const size_t bytes = type_bytes[h.type];
+    size_t in_bytes, target_bytes;
+
+    if (h.in_n > INT_MAX || h.out_n > INT_MAX || blockBytes(h.n_samples, h.in_n, bytes, &in_bytes) != 0 ||
+        blockBytes(h.n_samples, h.out_n, bytes, &target_bytes) != 0)
+        return -1;
+
+    // Offsets Are Bounded by the File First, so the Sums Below Cannot Wrap Either
+
+    if (h.in_offset % DatasetAlign != 0 || h.target_offset % DatasetAlign != 0 ||
+        h.in_offset < sizeof(h) || h.in_offset > ds->map_bytes || h.target_offset > ds->map_bytes ||
+        h.target_offset < h.in_offset || in_bytes > h.target_offset - h.in_offset ||
+        target_bytes > ds->map_bytes - h.target_offset)
+        return -1;
+
+    posix_madvise(ds->map, ds->map_bytes, POSIX_MADV_SEQUENTIAL);
+
+    ds->format = DatasetBinary;
+    ds->type = (DatasetType)h.type;
+    ds->in_n = (int)h.in_n;
+    ds->out_n = (int)h.out_n;
+    ds->n_samples = (size_t)h.n_samples;
+    ds->in = (const char *)ds->map + h.in_offset;
+    ds->target = (const char *)ds->map + h.target_offset;
+
+    return 0;
+}
+
+// Helper Function to Widen n float32 Values into a double Buffer
+static void widenValues(const float *src, double *dst, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        dst[i] = src[i];
+}
+
+// Helper Function to Parse One CSV Row into in_n Inputs and out_n Targets
+// Returns 0 on Success, -1 if the Row Has Too Few Values or Junk
+static int parseRow(const char *line, int in_n, int out_n, double *in, double *target)
+{
+    const char *p = line;
+
+    for (int i = 0; i < in_n + out_n; i++)
+    {
+        char *end;
+        double v = strtod(p, &end);
+
+        if (end == p)
+            return -1;
+
+        if (i < in_n)
+            in[i] = v;
+        else
+            target[i - in_n] = v;
+
+        while (*end == ' ' || *end == '\t')
+            end++;
+
+        if (i < in_n + out_n - 1 && *end++ != ',')
+            return -1;
+
+        p = end;
+    }
+
+    return (*p == '\0' || *p == '\n' || *p == '\r') ? 0 : -1;
+}
+
+// ***********************************
+// Dataset Interface
+// ***********************************
+
+// Function to Open a Dataset, the Format Detected from Its First Bytes
+Dataset *openDataset(const char *path, int in_n, int out_n, size_t chunk)
+{
+    Dataset *ds = calloc(1, sizeof(Dataset));
+    if (ds == NULL)
+        return NULL;
+
+    ds->chunk = (chunk > 0) ? chunk : DefaultChunk;
+
+    int fd = open(path, O_RDONLY);
+    char magic[4] = { 0 };
+
+    if (fd < 0)
+    {
+        free(ds);
+        return NULL;
+    }
+
+    if (read(fd, magic, sizeof(magic)) == (ssize_t)sizeof(magic) && memcmp(magic, DatasetMagic, sizeof(magic)) == 0)
+    {
+        int failed = mapBinary(ds, fd, in_n, out_n);
+
+        close(fd);          // The Mapping Keeps the File Open
+
+        if (!failed && ds->type == DatasetFloat32)
+        {
+            ds->in_buf = malloc(ds->chunk * ds->in_n * sizeof(double));
+            ds->target_buf = malloc(ds->chunk * ds->out_n * sizeof(double));
+            failed = (ds->in_buf == NULL || ds->target_buf == NULL);
+        }
+
+        if (failed)
+        {
+            closeDataset(ds);
+            return NULL;
+        }
+
+        return ds;
+    }
+
+    // CSV, Widths Come from the Caller
+
+    close(fd);
+
+    if (in_n < 1 || out_n < 1)
+    {
+        free(ds);
+        return NULL;
+    }
+
+    ds->format = DatasetCsv;
+    ds->in_n = in_n;
+    ds->out_n = out_n;
+    ds->file = fopen(path, "r");
+    ds->in_buf = malloc(ds->chunk * in_n * sizeof(double));
+    ds->target_buf = malloc(ds->chunk * out_n * sizeof(double));
+
+    if (ds->file == NULL || ds->in_buf == NULL || ds->target_buf == NULL)
+    {
+        closeDataset(ds);
+        return NULL;
+    }
+
+    setvbuf(ds->file, NULL, _IOFBF, CsvBuffer);
+    posix_fadvise(fileno(ds->file), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    return ds;
+}
+
+// Function to Release a Dataset
+void closeDataset(Dataset *ds)
+{
+    if (ds == NULL)
+        return;
+
+    if (ds->map != NULL)
+        munmap(ds->map, ds->map_bytes);
+    if (ds->file != NULL)
+        fclose(ds->file);
+
+    free(ds->line);
+    free(ds->in_buf);
+    free(ds->target_buf);
+    free(ds);
+}
+
+// Function to Get the Next Chunk, Returns Samples in It, 0 at the End of the Data
+// double Binary Chunks Are Views of the Mapping, float32 and CSV Chunks Only Ever Hold chunk Rows in Memory
+size_t readChunk(Dataset *ds, const double **in, const double **target)
+{
+    size_t rows = 0;
+
+    if (ds->format == DatasetBinary)
+    {
+        rows = (ds->n_samples - ds->next < ds->chunk) ? ds->n_samples - ds->next : ds->chunk;
+
+        if (ds->type == DatasetFloat32)
+        {
+            widenValues((const float *)ds->in + ds->next * ds->in_n, ds->in_buf, rows * ds->in_n);
+            widenValues((const float *)ds->target + ds->next * ds->out_n, ds->target_buf, rows * ds->out_n);
+
+            *in = ds->in_buf;
+            *target = ds->target_buf;
+        }
+        else
+        {
+            *in = (const double *)ds->in + ds->next * ds->in_n;
+            *target = (const double *)ds->target + ds->next * ds->out_n;
+        }
+
+        ds->next += rows;
+
+        return rows;
+    }
+
+    while (rows < ds->chunk && !ds->error && getline(&ds->line, &ds->line_cap, ds->file) > 0)
+    {
+        ds->line_no++;
+
+        if (ds->line[strspn(ds->line, " \t\r\n")] == '\0')     // Skip Blank Lines
+            continue;
+
+        if (parseRow(ds->line, ds->in_n, ds->out_n, ds->in_buf + rows * ds->in_n, ds->target_buf + rows * ds->out_n) != 0)
+        {
+            if (ds->line_no == 1)           // A Header Line is Fine, a Bad Row Later is Not
+                continue;
+
+            fprintf(stderr, "Malformed CSV Row on Line %zu!\n", ds->line_no);
+            ds->error = 1;
+            break;
+        }
+
+        rows++;
+    }
+
+    *in = ds->in_buf;
+    *target = ds->target_buf;
+    ds->next += rows;
+
+    if (rows == 0 && !ds->error)
+        ds->n_samples = ds->next;
+
+    return rows;
+}
+
+// Function to Restart from the First Sample, for the Next Epoch
+void rewindDataset(Dataset *ds)
+{
+    ds->next = 0;
+    ds->line_no = 0;
+
+    if (ds->file != NULL)
+        rewind(ds->file);
+}
+
+// ***********************************
+// Binary Dataset Writer
+// ***********************************
+
+// Helper Function to Write n Values at a File Offset, Narrowed First for a float32 Dataset
+static int writeValues(DatasetWriter *w, const double *src, size_t n, off_t offset)
+{
+    if (w->header.type == DatasetDouble)
+        return (pwrite(w->fd, src, n * sizeof(double), offset) == (ssize_t)(n * sizeof(double))) ? 0 : -1;
+
+    for (size_t i = 0; i < n; i += NarrowBlock)
+    {
+        const size_t m = (n - i < NarrowBlock) ? n - i : NarrowBlock;
+
+        for (size_t k = 0; k < m; k++)
+            w->narrow[k] = (float)src[i + k];
+
+        if (pwrite(w->fd, w->narrow, m * sizeof(float), offset + (off_t)(i * sizeof(float))) != (ssize_t)(m * sizeof(float)))
+            return -1;
+    }
+
+    return 0;
+}
+
+// Function to Name a Value Type
+const char *datasetTypeName(DatasetType type)
+{
+    return (type >= 0 && type < DatasetTypes) ? type_names[type] : "unknown";
+}
+
+// Function to Parse a Value Type Name, Returns -1 if Unknown
+int parseDatasetType(const char *name)
+{
+    for (int i = 0; i < DatasetTypes; i++)
+        if (strcmp(name, type_names[i]) == 0)
+            return i;
+
+    return -1;
+}
+
+// Function to Create a Binary Dataset of n_samples Samples
+// The File is Sized Up Front, so Alignment Gaps Read as Zeros and Blocks Fill in Place
+DatasetWriter *createDatasetWriter(const char *path, int in_n, int out_n, size_t n_samples, DatasetType type)
+{
+    if (in_n < 1 || out_n < 1 || type < 0 || type >= DatasetTypes)
+        return NULL;
+
+    DatasetWriter *w = calloc(1, sizeof(DatasetWriter));
+    if (w == NULL)
+        return NULL;
+
+    layoutHeader(&w->header, in_n, out_n, n_samples, type);
+
+    const off_t bytes = (off_t)(w->header.target_offset + n_samples * out_n * type_bytes[type]);
+
+    w->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    w->narrow = (type == DatasetFloat32) ? malloc(NarrowBlock * sizeof(float)) : NULL;
+
+    if (w->fd < 0 || (type == DatasetFloat32 && w->narrow == NULL) || ftruncate(w->fd, bytes) != 0 ||
+        pwrite(w->fd, &w->header, sizeof(w->header), 0) != (ssize_t)sizeof(w->header))
+    {
+        if (w->fd >= 0)
+            close(w->fd);
+        free(w->narrow);
+        free(w);
+        return NULL;
+    }
+
+    return w;
+}
+
+// Function to Append n Samples of [n][width] Rows, Returns 0 on Success
+int writeDataset(DatasetWriter *w, const double *in, const double *target, size_t n)
+{
+    const DatasetHeader *h = &w->header;
+    const size_t bytes = type_bytes[h->type];
+
+    if (w->written + n > h->n_samples)
+        return -1;
+
+    if (writeValues(w, in, n * h->in_n, (off_t)(h->in_offset + w->written * h->in_n * bytes)) != 0 ||
+        writeValues(w, target, n * h->out_n, (off_t)(h->target_offset + w->written * h->out_n * bytes)) != 0)
+        return -1;
+
+    w->written += n;
+
+    return 0;
+}
+
+// Function to Finish a Binary Dataset, Returns 0 Only if Every Sample Was Written and Reached the File
+int closeDatasetWriter(DatasetWriter *w)
+{
+    if (w == NULL)
+        return -1;
+
+    int ok = (w->written == w->header.n_samples) && fsync(w->fd) == 0;
+
+    ok = (close(w->fd) == 0) && ok;
+
+    free(w->narrow);
+    free(w);
+
+    return ok ? 0 : -1;
+}
+
+// Function to Write Samples of [n][width] Rows as a Binary Dataset, Returns 0 on Success
+int saveDataset(const char *path, const double *in, const double *target, size_t n, int in_n, int out_n, DatasetType type)
+{
+    DatasetWriter *w = createDatasetWriter(path, in_n, out_n, n, type);
+
+    if (w == NULL)
+        return -1;
+
+    int failed = writeDataset(w, in, target, n);
+
+    return (closeDatasetWriter(w) == 0 && !failed) ? 0 : -1;
+}
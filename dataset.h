@@ -0,0 +1,107 @@
+// ********************************************************************************
+// Labeled Datasets Streamed from CSV or Memory-Mapped from Binary Files
+// ********************************************************************************
+
+#ifndef DATASET_H
+#define DATASET_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Definitions - Macros
+#define DatasetMagic "EBPD"             // First Bytes of a Binary Dataset
+#define DatasetVersion 1                // Bumped Whenever the Layout Below Changes
+#define DatasetAlign 4096               // Blocks Start on Page Boundaries, so Mapped Blocks Are Page Aligned
+#define DefaultChunk 4096               // Samples per Chunk Unless Asked Otherwise
+
+typedef enum
+{
+    DatasetCsv,         // One Sample per Line, in_n Inputs Then out_n Targets, Comma-Separated
+    DatasetBinary       // DatasetHeader, Then an Aligned Block of All Inputs [n][in_n], Then One of All Targets [n][out_n]
+} DatasetFormat;
+
+// Type of the Values in a Binary Dataset
+typedef enum
+{
+    DatasetDouble,      // 8 Bytes per Value, Used in Place
+    DatasetFloat32,     // 4 Bytes per Value, Half the File, Widened a Chunk at a Time
+    DatasetTypes
+} DatasetType;
+
+// Header of a Binary Dataset, Little-Endian as Written
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t in_n;
+    uint32_t out_n;
+    uint64_t n_samples;
+    uint32_t type;              // DatasetType
+    uint32_t reserved;
+    uint64_t in_offset;         // File Offset of the Input Block, a Multiple of DatasetAlign
+    uint64_t target_offset;     // File Offset of the Target Block, a Multiple of DatasetAlign
+} DatasetHeader;
+
+// A Binary Dataset Being Written, Samples Appended to Both Blocks in Order
+typedef struct
+{
+    int fd;
+    DatasetHeader header;
+    size_t written;             // Samples Written So Far
+    float *narrow;              // Conversion Buffer of a float32 Dataset
+} DatasetWriter;
+
+// An Open Dataset, Read One Chunk of Samples at a Time
+typedef struct
+{
+    DatasetFormat format;
+    DatasetType type;
+    int in_n;                   // Inputs per Sample
+    int out_n;                  // Targets per Sample
+    size_t n_samples;           // Samples in File, for CSV Only Known After a Full Pass
+    size_t chunk;               // Samples per Chunk
+    size_t next;                // Index of Next Sample to Read
+    int error;                  // Set When a Malformed Row Stopped Reading
+
+    // Binary, Whole File Mapped, double Chunks Point Straight into It
+    void *map;
+    size_t map_bytes;
+    const void *in;
+    const void *target;
+
+    // CSV Rows Parsed, or float32 Values Widened, a Chunk at a Time into Owned Buffers
+    FILE *file;
+    char *line;
+    size_t line_cap;
+    size_t line_no;             // Lines Read This Pass, Including Header and Blank Lines
+    double *in_buf;
+    double *target_buf;
+} Dataset;
+
+// Function to Open a Dataset, the Format Detected from Its First Bytes
+// CSV Needs in_n and out_n, a Binary File Has Them in Its Header (Checked if Non-Zero)
+Dataset *openDataset(const char *path, int in_n, int out_n, size_t chunk);
+void closeDataset(Dataset *ds);
+
+// Function to Get the Next Chunk, Returns Samples in It, 0 at the End of the Data
+// Pointers Stay Valid Until the Next Call
+size_t readChunk(Dataset *ds, const double **in, const double **target);
+
+// Function to Restart from the First Sample, for the Next Epoch
+void rewindDataset(Dataset *ds);
+
+// Function to Name a Value Type, and to Parse One (double or float32), -1 if Unknown
+const char *datasetTypeName(DatasetType type);
+int parseDatasetType(const char *name);
+
+// Functions to Write a Binary Dataset of n_samples Samples, Streamed in Any Number of Calls
+// closeDatasetWriter() Returns 0 Only if Every Sample Was Written and Reached the File
+DatasetWriter *createDatasetWriter(const char *path, int in_n, int out_n, size_t n_samples, DatasetType type);
+int writeDataset(DatasetWriter *w, const double *in, const double *target, size_t n);
+int closeDatasetWriter(DatasetWriter *w);
+
+// Function to Write Samples of [n][width] Rows as a Binary Dataset, Returns 0 on Success
+int saveDataset(const char *path, const double *in, const double *target, size_t n, int in_n, int out_n, DatasetType type);
+
+#endif
@@ -2,260 +2,478 @@
 // First Serial Implementation of Error Back - Propagation Neural Network Algorithm
 // ********************************************************************************
 
+#define _POSIX_C_SOURCE 200112L
+
 // Include Libraries
 #include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
 #include <time.h>
+#include <unistd.h>
+
+#include "network.h"
+#include "rng.h"
+#include "quant.h"
+#include "dataset.h"
+#include "prefetch.h"
+#include "checkpoint.h"
+#include "roofline.h"
 
 // Definitions - Macros
-#define HiddenN 100
-#define OutN 10
-#define InN 12
+#define DefaultTopology "12,100,10"
 #define InMaxValue 1
 #define OutMaxValue 1
 #define MaxIter 10000
-
-// Declare Arrays
-double WL1[HiddenN][InN + 1];   // Hidden Layer Weights
-double WL2[OutN][HiddenN + 1];  // Output Layer Weights
-double DL1[HiddenN];            // Hidden Layer Values
-double DL2[OutN];               // Output Layer Values
-double OL1[HiddenN];            // Hidden Layer Output
-double OL2[OutN];               // Output Layer Output
-double in_vector[InN];          // Training Input Vector
-double out_vector[OutN];        // Training Output Vector
-double x_test[InN];             // Testing Input Vector
-double y_test[OutN];            // Testing Output Vector
+#define HeldOutN 1000   // Samples Scoring the Quantized Network
+#define StatsInterval 1.0   // Seconds Between Stats Lines When Built with EBP_STATS
 
 const double learn_rate = 0.4f;     // Set Learning Rate
 const double max_error = 0.001f; // Set Error to Converge to
 
-// *******************************************************************
-#pragma GCC optimize("O3","unroll-loops","omit-frame-pointer","inline", "unsafe-math-optimizations")
-#pragma GCC option("arch=native","tune=native","no-zero-upper")
-//************************************************************
-
 // ***********************************
 // Helper Functions
 // ***********************************
 
-// Helper Function to Calculate Using Sigmoid Calculation
-double sigmoid(double x)
-{
-    return 1 / (1 + exp(-x));
-}
-
-// Helper Function to Calculate Using Derivative of Sigmoid Calculation
-double dSigmoid(double x)
-{
-    return x * (1 - x);
-}
-
-// Helper Function to Generate Random Weight
-double initWeight(void)
+// Helper Function to Generate Random Input Vector, Elements first to first + n - 1 of the Seed's Stream
+void generateInput(double *in_vector, int n, uint64_t seed, size_t first)
 {
-    return ((double)rand())/((double)RAND_MAX);
+    for (int i = 0; i < n; i++)
+    {
+        in_vector[i] = (rngUniform(seed, RngInputs, first + i) - 0.5) * InMaxValue;
+    }
 }
 
-// Helper Function to Generate Random Input Vector
-void generateInput(void)
+// Helper Function to Generate Random Output Vector, Elements first to first + n - 1 of the Seed's Stream
+void generateOutput(double *out_vector, int n, uint64_t seed, size_t first)
 {
-    for (int i = 0; i < InN; i++)
+    for (int i = 0; i < n; i++)
     {
-        in_vector[i] = (double)(((double)rand() - RAND_MAX / 2) / (double)RAND_MAX * InMaxValue);
+        out_vector[i] = (rngUniform(seed, RngOutputs, first + i) - 0.5) * OutMaxValue;
     }
 }
 
-// Helper Function to Generate Random Output Vector
-void generateOutput(void)
+// Helper Function to Generate a Batch of Random Input and Output Vectors
+void generateBatch(double *in_batch, int in_n, double *out_batch, int out_n, int batch, uint64_t seed)
 {
-    for (int i = 0; i < OutN; i++)
+    for (int b = 0; b < batch; b++)
     {
-        out_vector[i] = (double)(((double)rand() - RAND_MAX / 2) / (double)RAND_MAX * OutMaxValue);
+        generateInput(in_batch + (size_t)b * in_n, in_n, seed, (size_t)b * in_n);
+        generateOutput(out_batch + (size_t)b * out_n, out_n, seed, (size_t)b * out_n);
     }
 }
 
 // Helper Function to Print Input and Output Vectors
-void printInOut(void)
+void printInOut(const double *in_vector, int in_n, const double *out_vector, int out_n)
 {
     printf("Printing Input Vector...\n");
-    for (int i = 0; i < (InN - 1); i++)
+    for (int i = 0; i < (in_n - 1); i++)
     {
         printf("%f, ", in_vector[i]);
     }
-    printf("%f\n\n", in_vector[InN - 1]);
+    printf("%f\n\n", in_vector[in_n - 1]);
 
     printf("Printing Output Vector...\n");
-    for (int i = 0; i < (OutN - 1); i++)
+    for (int i = 0; i < (out_n - 1); i++)
     {
         printf("%f, ", out_vector[i]);
     }
-    printf("%f\n\n", out_vector[OutN - 1]);
+    printf("%f\n\n", out_vector[out_n - 1]);
 }
 
-// Function to Initialize All Weights Using init_weight
-void initializeWeights(void)
+// Helper Function to Train One Epoch over a Dataset, Chunk by Chunk as the Prefetcher Hands Them Over
+// Returns the Mean Error of Each Sample Just Before Its Update
+double trainEpoch(Network *net, Workspace *ws, Prefetcher *pf, int batch)
 {
-    for (int i = 0; i < HiddenN; i++)
-    {
-        WL1[i][InN] = 1;             // Add Bias
-
-        for (int j = 0; j < InN; j++)
-            WL1[i][j] = initWeight();
-    }
+    const Dataset *ds = pf->ds;
+    const double *in, *target;
+    double total_error = 0;
+    size_t seen = 0;
+    size_t rows;
 
-    for (int i = 0; i < OutN; i++)
+    while ((rows = nextChunk(pf, &in, &target)) > 0)
     {
-        WL2[i][HiddenN] = 1;            // Add Bias
-
-        for (int j = 0; j < HiddenN; j++)
-            WL2[i][j] = initWeight();
+        for (size_t s = 0; s < rows; s += batch)
+        {
+            const int m = (rows - s < (size_t)batch) ? (int)(rows - s) : batch;
+            const double *x = in + s * ds->in_n;
+            const double *t = target + s * ds->out_n;
+
+            if (m > 1)
+            {
+                activateNNBatch(net, ws, x, m);
+                total_error += calcErrorBatch(net, ws, t, m) * m;
+                trainNNBatch(net, ws, t, m);
+            }
+            else
+            {
+                activateNN(net, ws, x);
+                total_error += calcError(net, ws, t);
+                trainNN(net, ws, t);
+            }
+
+            seen += m;
+        }
     }
+
+    return (seen > 0) ? total_error / seen : 0;
 }
 
-// Function to Activate Neural Network
-void activateNN(void)                   // TODO: Possibly Add Parameter Option
+// Helper Function to Print Usage
+void printUsage(const char *name)
 {
-    // Forward Pass for Hidden Layer
+    fprintf(stderr, "Usage: %s [-l widths] [-b batch] [-a tier] [-L layout] [-p type] [-s seed] [-q] [-d file] [-e epochs] [-c file [-i epochs] [-w seconds]] [-r file]\n", name);
+    fprintf(stderr, "  -l widths   Comma-Separated Layer Widths, Input First (Default %s)\n", DefaultTopology);
+    fprintf(stderr, "  -b batch    Samples per Training Step (Default 1)\n");
+    fprintf(stderr, "  -a tier     Sigmoid Accuracy: exact, precise (1e-7) or fast (1e-3) (Default exact)\n");
+    fprintf(stderr, "  -L layout   Weight Layout of Batched Passes, rows or panels, or forward,backward (Default panels)\n");
+    fprintf(stderr, "  -p type     Precision: double, float or mixed (float Weights, double Sums) (Default double)\n");
+    fprintf(stderr, "  -s seed     Seed of All Random Data and Weights (Default Current Time)\n");
+    fprintf(stderr, "  -q          Quantize to int8 After Training and Report Accuracy Loss on Held-Out Samples\n");
+    fprintf(stderr, "  -d file     Train on a CSV (Inputs Then Targets per Line) or Binary Dataset, Shuffled per Chunk, Instead of Random Data\n");
+    fprintf(stderr, "  -e epochs   Stop After This Epoch Even if the Error is Still Above Target (Default %d)\n", MaxIter);
+    fprintf(stderr, "  -c file     Save a Checkpoint of Weights and Progress When Training Stops\n");
+    fprintf(stderr, "  -i epochs   Also Checkpoint Every This Many Epochs, Written in the Background\n");
+    fprintf(stderr, "  -w seconds  Also Checkpoint When This Long Has Passed Since the Last, Written in the Background\n");
+    fprintf(stderr, "  -r file     Resume from a Checkpoint, Whose Topology, Precision, Tier and Seed Replace -l, -p, -a and -s\n");
+}
 
-    for (int i = 0; i < HiddenN; i++)   // For All Neurons in Hidden Layer
+// Driver Function
+int main(int argc, char *argv[])
+{
+    int widths[MaxLayers];
+    int n_widths = parseTopology(DefaultTopology, widths, MaxLayers);
+    int batch = 1;  // Samples per Training Step
+    int tier = SigmoidExact;
+    int bad_layout = 0;
+    WeightLayout layouts[2] = { LayoutPanels, LayoutPanels };  // Forward and Backward
+    int precision = PrecisionDouble;
+    uint64_t seed = (uint64_t)time(0);  // Seed of All Generated Data and Weights
+    int quantized = 0;  // Report int8 Inference Accuracy After Training
+    const char *data_path = NULL;   // Dataset to Train On, Random Data if NULL
+    int last_epoch = MaxIter;       // Epoch Training Stops After
+    const char *save_path = NULL;   // Checkpoint Written When Training Stops
+    int every_epochs = 0;           // Background Checkpoint Interval in Epochs, 0 for None
+    double every_seconds = 0;       // Background Checkpoint Interval in Seconds, 0 for None
+    const char *resume_path = NULL; // Checkpoint to Resume From
+    int opt;
+
+    while ((opt = getopt(argc, argv, "l:b:a:L:p:s:qd:e:c:i:w:r:")) != -1)
     {
-        DL1[i] = WL1[i][InN];            // Get Bias
-        for (int j = 0; j < InN; j++)    // From All Inputs
+        switch (opt)
         {
-            DL1[i] += (WL1[i][j] * in_vector[j]);
+            case 'l':
+                n_widths = parseTopology(optarg, widths, MaxLayers);
+                break;
+            case 'b':
+                batch = atoi(optarg);
+                break;
+            case 'a':
+                tier = parseSigmoidTier(optarg);
+                break;
+            case 'L':
+                bad_layout = (parseLayouts(optarg, &layouts[0], &layouts[1]) != 0);
+                break;
+            case 'p':
+                precision = parsePrecision(optarg);
+                break;
+            case 's':
+                seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'q':
+                quantized = 1;
+                break;
+            case 'd':
+                data_path = optarg;
+                break;
+            case 'e':
+                last_epoch = atoi(optarg);
+                break;
+            case 'c':
+                save_path = optarg;
+                break;
+            case 'i':
+                every_epochs = atoi(optarg);
+                break;
+            case 'w':
+                every_seconds = atof(optarg);
+                break;
+            case 'r':
+                resume_path = optarg;
+                break;
+            default:
+                printUsage(argv[0]);
+                return 1;
         }
+    }
 
-        OL1[i] = sigmoid(DL1[i]);       // Calculate Output from Sigmoid
+    if (n_widths == 0 || batch < 1 || tier < 0 || bad_layout || precision < 0 || last_epoch < 1 || every_epochs < 0 || every_seconds < 0)
+    {
+        printUsage(argv[0]);
+        return 1;
     }
 
-    // Forward Pass for Output Layer
+    TrainState state = { 0, seed, 1 };
+    Network *net = NULL;
 
-    for (int i = 0; i < OutN; i++)    // For All Neurons in Output Layer
+    if (resume_path != NULL)
     {
-        DL2[i] = WL2[i][HiddenN];           // Get Bias
-        for (int j = 0; j < HiddenN; j++)   // From All Neurons in Hidden Layer
+        // Pick Up Where the Checkpoint Left Off, Its Network and Seed Replace the Options
+        if ((net = loadCheckpoint(resume_path, &state)) == NULL)
         {
-            DL2[i] += (WL2[i][j] * OL1[j]);
+            fprintf(stderr, "Failed to Load Checkpoint %s!\n", resume_path);
+            return 1;
         }
 
-        OL2[i] = sigmoid(DL2[i]);       // Calculate Output from Sigmoid
+        seed = state.seed;
+        n_widths = net->n_layers + 1;
+        for (int l = 0; l < n_widths; l++)
+            widths[l] = net->widths[l];
     }
-}
 
-// Function to Calculate Total Error in Network
-double calcError(void)
-{
-    double total_error = 0;
-    double temp_error;
+    const int in_n = widths[0];
+    const int out_n = widths[n_widths - 1];
 
-    for (int i = 0; i < OutN; i++)
-    {
-        temp_error = out_vector[i] - OL2[i];
-        total_error += 0.5 * (temp_error * temp_error);
-    }
+    if (net == NULL)
+        net = createNN(widths, n_widths, learn_rate, (Precision)precision);
 
-    return total_error;
-}
+    Workspace *ws = (net != NULL) ? createWorkspace(net, batch) : NULL;
+    double *in_vector = malloc((size_t)batch * in_n * sizeof(double));      // Training Input Vectors
+    double *out_vector = malloc((size_t)batch * out_n * sizeof(double));    // Training Output Vectors
+    Dataset *ds = NULL;
+    Prefetcher *pf = NULL;
 
-// Function to Train Neural Network
-void trainNN(void)
-{
-    double delta_out[OutN];
-    for (int i = 0; i < OutN; i++)
+    if (ws == NULL || in_vector == NULL || out_vector == NULL)
     {
-        double error_out = (out_vector[i] - OL2[i]);
-        delta_out[i] = (error_out * dSigmoid(OL2[i]));
+        fprintf(stderr, "Failed to Allocate Network!\n");
+        return 1;
     }
 
-    double delta_hidden[HiddenN];
-    for (int i = 0; i < HiddenN; i++)
+    if (data_path != NULL && (ds = openDataset(data_path, in_n, out_n, DefaultChunk)) == NULL)
     {
-        double error_hidden = 0.0f;
-        for (int j = 0; j < OutN; j++)
-        {
-            error_hidden += (delta_out[j] * WL2[j][i]); // TODO: Confirm Correct Indexing
-        }
-
-        delta_hidden[i] = (error_hidden * dSigmoid(OL1[i]));
+        fprintf(stderr, "Failed to Open Dataset %s with %d Inputs and %d Targets!\n", data_path, in_n, out_n);
+        return 1;
     }
 
-    // Update Output Layer Weights
-
-    for (int i = 0; i < OutN; i++)                  // For All Neurons in Output Layer
+    // Chunks Are Read and Shuffled on a Producer Thread While the Previous One Trains
+    if (ds != NULL && (pf = createPrefetcher(ds, 1, seed, state.epoch + 1)) == NULL)
     {
-        WL2[i][HiddenN] += (delta_out[i] * learn_rate); // Update Bias
-        for (int j = 0; j < HiddenN; j++)               // Calculate New Weights from Hidden Layer Neurons
-        {
-            WL2[i][j] += (OL1[j] * delta_out[i]) * learn_rate;
-        }
+        fprintf(stderr, "Failed to Start Dataset Prefetch!\n");
+        return 1;
     }
 
-    // Update Hidden Layer Weights
+    if (resume_path == NULL)
+        net->sigmoid_tier = (SigmoidTier)tier;
+
+    net->forward_layout = layouts[0];
+    net->backward_layout = layouts[1];
 
-    for (int i = 0; i < HiddenN; i++)               // For All Neurons in Hidden Layer
+    // Periodic Checkpoints Cost Training One Copy of the Weights, a Writer Thread Does the Rest
+    Checkpointer *cp = NULL;
+
+    if (save_path != NULL && (every_epochs > 0 || every_seconds > 0) &&
+        (cp = createCheckpointer(save_path, net, every_epochs, every_seconds)) == NULL)
     {
-        WL1[i][InN] += (delta_hidden[i] * learn_rate);  // Update Bias
-        for (int j = 0; j < InN; j++)                   // Calculate New Weights from Input
-        {
-            WL1[i][j] += (in_vector[j] * delta_hidden[i]) * learn_rate;
-        }
+        fprintf(stderr, "Failed to Start Checkpoint Writer!\n");
+        return 1;
     }
-}
 
-// Driver Function
-int main(void)
-{
-    srand(time(0));  // Create Seed for rand()
+    printf("Seed = %llu\n", (unsigned long long)seed);  // Print Seed to Reproduce This Run
 
     double total_error = 1;
-    int epoch = 1;
+    int epoch = (int)state.epoch + 1;
+    int failed = 0;     // Dataset Error, Training Stops and Nothing is Saved
 
-    // Generate Random Input
-    generateInput();
+    if (resume_path != NULL)
+        printf("Resuming %s After Epoch %d, Error = %f\n", resume_path, epoch - 1, state.error);
+
+    if (ds == NULL && batch > 1)
+    {
+        // Generate Random Training Batch
+        generateBatch(in_vector, in_n, out_vector, out_n, batch, seed);
+    }
+    else if (ds == NULL)
+    {
+        // Generate Random Input
+        generateInput(in_vector, in_n, seed, 0);
 
-    // Generate Random Output
-    generateOutput();
+        // Generate Random Output
+        generateOutput(out_vector, out_n, seed, 0);
 
-    // Print Generated Vectors
-    printInOut();
+        // Print Generated Vectors
+        printInOut(in_vector, in_n, out_vector, out_n);
+    }
 
     // Initialize Weights
-    initializeWeights();
+    if (resume_path == NULL)
+        initializeWeights(net, seed);
 
-    // Initial Network Activation
-    activateNN();
+    // Initial Network Activation and Error, a Dataset's Error Comes with Its First Epoch
+    if (ds == NULL)
+    {
+        if (batch > 1)
+            activateNNBatch(net, ws, in_vector, batch);
+        else
+            activateNN(net, ws, in_vector);
 
-    // Calculate Initial Error
-    total_error = calcError();
+        // Calculate Initial Error
+        total_error = (batch > 1) ? calcErrorBatch(net, ws, out_vector, batch) : calcError(net, ws, out_vector);
 
-    printf("Initial Error = %f!\n", total_error);   // Print Initial Activation Error
+        printf("Initial Error = %f!\n", total_error);   // Print Initial Activation Error
+    }
 
     // Train Model
 
+#ifdef EBP_STATS
+    StatsReporter rep;
+    PhaseStats *stats_of[1] = { ws->stats };
+    startStats(&rep, stats_of, 1, StatsInterval, epoch);
+#endif
+
     while (total_error > max_error)
     {
-        // Update Weights Using Error Back-Propagation
-        trainNN();
+        if (ds != NULL)
+        {
+            // One Pass over the Dataset, Its Error Only Counts If Every Chunk Was Read
+            const double error = trainEpoch(net, ws, pf, batch);
+
+            if (prefetchFailed(pf))
+            {
+                failed = 1;
+                break;
+            }
+
+            total_error = error;
+        }
+        else if (batch > 1)
+        {
+            // Update Weights Once per Batch Using Averaged Error Back-Propagation
+            trainNNBatch(net, ws, out_vector, batch);
+
+            // Activate Neurons for Whole Batch
+            activateNNBatch(net, ws, in_vector, batch);
 
-        // Activate Neurons
-        activateNN();
+            // Calculate New Mean Error
+            total_error = calcErrorBatch(net, ws, out_vector, batch);
+        }
+        else
+        {
+            // Update Weights Using Error Back-Propagation
+            trainNN(net, ws, out_vector);
+
+            // Activate Neurons
+            activateNN(net, ws, in_vector);
 
-        // Calculate New Error
-        total_error = calcError();
+            // Calculate New Error
+            total_error = calcError(net, ws, out_vector);
+        }
 
         printf("Epoch %d - Error = %f!\n", epoch, total_error);  // Print Epoch Information
 
+#ifdef EBP_STATS
+        tickStats(&rep, epoch);
+#endif
+
+        if (cp != NULL)
+        {
+            // Snapshot the Weights if a Checkpoint is Due
+            state.epoch = (uint64_t)epoch;
+            state.error = total_error;
+            tickCheckpointer(cp, &state);
+        }
+
         epoch++;    // Increment Epoch Variable
 
-        if (epoch > MaxIter)
+        if (epoch > last_epoch)
         {
             break;
         }
     }
 
+    if (failed)
+        fprintf(stderr, "Failed to Read Dataset %s!\n", data_path);
+
+#ifdef EBP_STATS
+    finishStats(&rep, epoch - 1);
+
+    // Compare Each Phase's Achieved Rates Against This Machine's Measured Peaks
+    MachinePeaks peaks;
+    PhaseStats total;
+
+    sumStats(&rep, &total);
+
+    if (probeMachine(net, &peaks) == 0)
+        printRoofline(net, batch, &total, &peaks);
+    else
+        fprintf(stderr, "Failed to Probe Machine Peaks!\n");
+#endif
+
     printf("Final Error was %f!", total_error);
 
-    return 0;
-}
\ No newline at end of file
+    if (cp != NULL)
+    {
+        stopCheckpointer(cp);
+        printf("\nCheckpoints: %d Taken, %d Skipped While Writing, %d Failed, %zu Bytes Each", cp->taken, cp->skipped,
+               cp->failed, cp->bytes);
+        printf("\nTraining Stalled %f ms Mean, %f ms Max per Checkpoint, Writer Took %f ms Mean",
+               cp->taken ? cp->stall * 1e3 / cp->taken : 0.0, cp->stall_max * 1e3,
+               (cp->written + cp->failed) ? cp->write * 1e3 / (cp->written + cp->failed) : 0.0);
+        freeCheckpointer(cp);
+    }
+
+    if (save_path != NULL && !failed)
+    {
+        state.epoch = (uint64_t)(epoch - 1);
+        state.seed = seed;
+        state.error = total_error;
+
+        if (saveCheckpoint(save_path, net, &state) != 0)
+        {
+            fprintf(stderr, "\nFailed to Save Checkpoint %s!\n", save_path);
+            return 1;
+        }
+
+        printf("\nSaved Checkpoint %s After Epoch %d", save_path, epoch - 1);
+    }
+
+    if (pf != NULL)
+        printf("\nWaited %f s for Data", pf->wait);   // Training Stalled on the Prefetcher This Long
+
+    if (quantized && !failed)
+    {
+        // Score int8 Inference Against the Trained Network on Samples It Never Saw
+        QuantNetwork *q = quantizeNN(net);
+        QuantWorkspace *qws = (q != NULL) ? createQuantWorkspace(q) : NULL;
+        Workspace *held_ws = createWorkspace(net, 1);
+        double *held_in = malloc((size_t)HeldOutN * in_n * sizeof(double));
+        double *held_out = malloc((size_t)HeldOutN * out_n * sizeof(double));
+
+        if (qws == NULL || held_ws == NULL || held_in == NULL || held_out == NULL)
+        {
+            fprintf(stderr, "Failed to Allocate Quantized Network!\n");
+            return 1;
+        }
+
+        generateBatch(held_in, in_n, held_out, out_n, HeldOutN, ~seed);
+
+        QuantReport r = compareQuantNN(net, held_ws, q, qws, held_in, held_out, HeldOutN);
+
+        printf("\nint8 Inference on %d Held-Out Samples: Error = %f (%s %f)\n", HeldOutN, r.error_quant,
+               precisionName(net->precision), r.error);
+        printf("Output Difference Mean = %e, Max = %e\n", r.mean_diff, r.max_diff);
+        printf("Model Size %zu Bytes int8, %zu Bytes float\n", q->bytes, net->n_weights * sizeof(float));
+
+        free(held_in);
+        free(held_out);
+        freeWorkspace(held_ws);
+        freeQuantWorkspace(qws);
+        freeQuantNN(q);
+    }
+
+    freePrefetcher(pf);
+    closeDataset(ds);
+    free(in_vector);
+    free(out_vector);
+    freeWorkspace(ws);
+    freeNN(net);
+
+    return failed;
+}
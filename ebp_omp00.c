@@ -2,316 +2,595 @@
 // First Parallel Implementation of Error Back - Propagation Neural Network Algorithm
 // **********************************************************************************
 
+#define _POSIX_C_SOURCE 200112L
+
 // Include Libraries
 #include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
 #include <time.h>
+#include <unistd.h>
 #include <omp.h>
 
+#include "network.h"
+#include "rng.h"
+#include "dataset.h"
+#include "prefetch.h"
+#include "checkpoint.h"
+#include "roofline.h"
+
 // Definitions - Macros
-#define HiddenN 100
-#define OutN 10
-#define InN 12
+#define DefaultTopology "12,100,10"
 #define InMaxValue 1
 #define OutMaxValue 1
 #define MaxIter 10000
-
-// Declare Arrays
-double WL1[HiddenN][InN + 1];   // Hidden Layer Weights
-double WL2[OutN][HiddenN + 1];  // Output Layer Weights
-double DL1[HiddenN];            // Hidden Layer Values
-double DL2[OutN];               // Output Layer Values
-double OL1[HiddenN];            // Hidden Layer Output
-double OL2[OutN];               // Output Layer Output
-double in_vector[InN];          // Training Input Vector
-double out_vector[OutN];        // Training Output Vector
-double x_test[InN];             // Testing Input Vector
-double y_test[OutN];            // Testing Output Vector
+#define MiniBatch 64    // Samples per Pass Through a Thread's Shard
+#define StatsInterval 1.0   // Seconds Between Stats Lines When Built with EBP_STATS
 
 const double learn_rate = 0.1f;     // Set Learning Rate
 const double max_error = 0.001f; // Set Error to Converge to
 
-// *******************************************************************
-#pragma GCC optimize("O3","unroll-loops","omit-frame-pointer","inline", "unsafe-math-optimizations")
-#pragma GCC option("arch=native","tune=native","no-zero-upper")
-//************************************************************
+// Chunk of a Dataset Pass Shared by the Team, Only Written Inside single
+static const double *chunk_in, *chunk_target;
+static size_t chunk_rows;
+static double sample_error;     // Error of the Current Single-Sample Step, Only Written Inside single
 
 // ***********************************
 // Helper Functions
 // ***********************************
 
-// Helper Function to Calculate Using Sigmoid Calculation
-double sigmoid(double x)
+// Helper Function to Generate Random Input Vector, Elements first to first + n - 1 of the Seed's Stream
+void generateInput(double *in_vector, int n, uint64_t seed, size_t first)
 {
-    return 1 / (1 + exp(-x));
-}
-
-// Helper Function to Calculate Using Derivative of Sigmoid Calculation
-double dSigmoid(double x)
-{
-    return x * (1 - x);
-}
-
-// Helper Function to Generate Random Weight
-double initWeight(void)
-{
-    return ((double)rand())/((double)RAND_MAX);
+    for (int i = 0; i < n; i++)
+    {
+        in_vector[i] = (rngUniform(seed, RngInputs, first + i) - 0.5) * InMaxValue;
+    }
 }
 
-// Helper Function to Generate Random Input Vector
-void generateInput(void)
+// Helper Function to Generate Random Output Vector, Elements first to first + n - 1 of the Seed's Stream
+void generateOutput(double *out_vector, int n, uint64_t seed, size_t first)
 {
-    for (int i = 0; i < InN; i++)
+    for (int i = 0; i < n; i++)
     {
-        in_vector[i] = (double)(((double)rand() - RAND_MAX / 2) / (double)RAND_MAX * InMaxValue);
+        out_vector[i] = (rngUniform(seed, RngOutputs, first + i) - 0.5) * OutMaxValue;
     }
 }
 
-// Helper Function to Generate Random Output Vector
-void generateOutput(void)
+// Helper Function to Generate a Batch of Random Input and Output Vectors
+void generateBatch(double *in_batch, int in_n, double *out_batch, int out_n, int batch, uint64_t seed)
 {
-    for (int i = 0; i < OutN; i++)
+    for (int b = 0; b < batch; b++)
     {
-        out_vector[i] = (double)(((double)rand() - RAND_MAX / 2) / (double)RAND_MAX * OutMaxValue);
+        generateInput(in_batch + (size_t)b * in_n, in_n, seed, (size_t)b * in_n);
+        generateOutput(out_batch + (size_t)b * out_n, out_n, seed, (size_t)b * out_n);
     }
 }
 
 // Helper Function to Print Input and Output Vectors
-void printInOut(void)
+void printInOut(const double *in_vector, int in_n, const double *out_vector, int out_n)
 {
     printf("Printing Input Vector...\n");
-    for (int i = 0; i < (InN - 1); i++)
+    for (int i = 0; i < (in_n - 1); i++)
     {
         printf("%f, ", in_vector[i]);
     }
-    printf("%f\n\n", in_vector[InN - 1]);
+    printf("%f\n\n", in_vector[in_n - 1]);
 
     printf("Printing Output Vector...\n");
-    for (int i = 0; i < (OutN - 1); i++)
+    for (int i = 0; i < (out_n - 1); i++)
     {
         printf("%f, ", out_vector[i]);
     }
-    printf("%f\n\n", out_vector[OutN - 1]);
+    printf("%f\n\n", out_vector[out_n - 1]);
 }
 
-// Function to Initialize All Weights Using init_weight
-void initializeWeights(void)
+// Parallel Helper Function to Generate Random Input Vector
+// Element i is Drawn from (seed, i) Alone, so the Vector is the Same for Any Thread Count
+void generateInput2(double *in_vector, int n, uint64_t seed)
 {
-    for (int i = 0; i < HiddenN; i++)
-    {
-        WL1[i][InN] = 1;             // Add Bias
+    int i;
 
-        for (int j = 0; j < InN; j++)
-            WL1[i][j] = initWeight();
-    }
-
-    for (int i = 0; i < OutN; i++)
+    #pragma omp parallel for private(i) schedule(auto)
+    for (i = 0; i < n; i++)
     {
-        WL2[i][HiddenN] = 1;            // Add Bias
-
-        for (int j = 0; j < HiddenN; j++)
-            WL2[i][j] = initWeight();
+        in_vector[i] = (rngUniform(seed, RngInputs, i) - 0.5) * InMaxValue;
     }
 }
 
-// Parallel Helper Function to Generate Random Input Vector
-void generateInput2(void)
+// Parallel Helper Function to Generate Random Output Vector
+void generateOutput2(double *out_vector, int n, uint64_t seed)
 {
-    #pragma omp parallel
+    int i;
+
+    #pragma omp parallel for private(i) schedule(auto)
+    for (i = 0; i < n; i++)
     {
+        out_vector[i] = (rngUniform(seed, RngOutputs, i) - 0.5) * OutMaxValue;
+    }
+}
 
-        int i;
+// Parallel Function to Initialize All Weights Using initWeight
+// Each Weight is Keyed by Its Position in the Arena, so Any Schedule Gives the Same Network
+void initializeWeights2(Network *net, uint64_t seed)
+{
+    int i, j;
 
-        srand((time(NULL)) ^ omp_get_thread_num());          // Create rand() Seed and Differentiate for Each Thread
+    for (int l = 0; l < net->n_layers; l++)
+    {
+        Layer *layer = &net->layers[l];
 
-        #pragma omp for private(i) schedule(auto)
-        for (i = 0; i < InN; i++)
+        #pragma omp parallel for private(i, j) schedule(auto) collapse(2)
+        for (i = 0; i < layer->out; i++)
         {
-            in_vector[i] = (double) (((double) rand() - RAND_MAX / 2) / (double) RAND_MAX * InMaxValue);
+            for (j = 0; j <= layer->in; j++)
+            {
+                size_t k = (size_t)i * layer->stride + j;
+
+                if (layer->Wf != NULL)
+                    layer->Wf[k] = (float)initWeight(seed, layer->offset + k);
+                else
+                    layer->W[k] = initWeight(seed, layer->offset + k);
+            }
         }
     }
 }
 
-// Parallel Helper Function to Generate Random Output Vector
-void generateOutput2(void)
+// Parallel Helper Function to Train One Epoch over a Dataset, Every Thread of the Team Must Call It
+// One Thread Takes Each Chunk from the Prefetcher, Then the Team Trains on It in Steps of batch Samples
+// Returns the Mean Error of Each Sample Just Before Its Update, the Same on Every Thread
+double trainEpoch2(Network *net, Workspace *ws, Workspace **shard_ws, double **grads, double *shard_error,
+                   Prefetcher *pf, int batch, int hogwild)
 {
-    #pragma omp parallel
+    const Dataset *ds = pf->ds;
+    const int tid = omp_get_thread_num();
+    double total_error = 0;
+    size_t seen = 0;
+
+    for (;;)
     {
-        int i;
+        #pragma omp single
+        chunk_rows = nextChunk(pf, &chunk_in, &chunk_target);
 
-        srand((time(NULL)) ^ omp_get_thread_num());          // Create rand() Seed and Differentiate for Each Thread
+        if (chunk_rows == 0)
+            break;
 
-        #pragma omp for private(i) schedule(auto)
-        for (i = 0; i < OutN; i++)
+        for (size_t s = 0; s < chunk_rows; s += batch)
         {
-            out_vector[i] = (double) (((double) rand() - RAND_MAX / 2) / (double) RAND_MAX * OutMaxValue);
-        }
-    }
-}
+            const int m = (chunk_rows - s < (size_t)batch) ? (int)(chunk_rows - s) : batch;
+            const double *x = chunk_in + s * ds->in_n;
+            const double *t = chunk_target + s * ds->out_n;
 
-// Parallel Function to Initialize All Weights Using init_weight
-void initializeWeights2(void)
-{
-    int i, j;
+            if (m > 1 && hogwild)
+            {
+                shard_error[tid] = trainNNHogwild(net, shard_ws[tid], x, t, m);
 
-    #pragma omp parallel for private(i, j) schedule(auto) collapse(2)
-    for (i = 0; i < HiddenN; i++)
-    {
-        for (j = 0; j <= InN; j++)
-            WL1[i][j] = initWeight();
-    }
+                #pragma omp barrier
 
-    #pragma omp parallel for private(i, j) schedule(auto) collapse(2)
-    for (i = 0; i < OutN; i++)
-    {
-        for (j = 0; j <= HiddenN; j++)
-            WL2[i][j] = initWeight();
+                for (int th = 0; th < omp_get_num_threads(); th++)
+                    total_error += shard_error[th];
+
+                #pragma omp barrier     // Sums Read Before the Next Step Overwrites Them
+            }
+            else if (m > 1)
+            {
+                total_error += trainNNData(net, shard_ws[tid], grads, x, t, m) * m;
+            }
+            else
+            {
+                activateNNTeam(net, ws, x);
+
+                #pragma omp single
+                sample_error = calcError(net, ws, t);
+
+                total_error += sample_error;
+                trainNNTeam(net, ws, t);
+            }
+
+            seen += m;
+        }
+
+        #pragma omp barrier     // The Chunk is Done with Before the Next Call Hands Its Slot Back
     }
+
+    return (seen > 0) ? total_error / seen : 0;
 }
 
-// Function to Activate Neural Network
-void activateNN(void)                   // TODO: Possibly Add Parameter Option
+// Helper Function to Print Usage
+void printUsage(const char *name)
 {
-    // Forward Pass for Hidden Layer
+    fprintf(stderr, "Usage: %s [-l widths] [-b batch] [-a tier] [-L layout] [-p type] [-t threads] [-s seed] [-H | -D] [-d file] [-e epochs] [-c file [-i epochs] [-w seconds]] [-r file]\n", name);
+    fprintf(stderr, "  -l widths   Comma-Separated Layer Widths, Input First (Default %s)\n", DefaultTopology);
+    fprintf(stderr, "  -b batch    Samples per Training Step, Sharded Across the Team (Default 1)\n");
+    fprintf(stderr, "  -a tier     Sigmoid Accuracy: exact, precise (1e-7) or fast (1e-3) (Default exact)\n");
+    fprintf(stderr, "  -L layout   Weight Layout of Batched Passes, rows or panels, or forward,backward (Default panels)\n");
+    fprintf(stderr, "  -p type     Precision: double, float or mixed (float Weights, double Sums) (Default double)\n");
+    fprintf(stderr, "  -t threads  Size of the Training Thread Team (Default OMP_NUM_THREADS)\n");
+    fprintf(stderr, "  -s seed     Seed of All Random Data, Weights and Sample Order (Default Current Time)\n");
+    fprintf(stderr, "  -H          Lock-Free Asynchronous (Hogwild) Updates Instead of the All-Reduce\n");
+    fprintf(stderr, "  -D          Deterministic, Same Seed and Threads Give the Same Error Trace, Printed per Epoch\n");
+    fprintf(stderr, "  -d file     Train on a CSV or Binary Dataset, One Epoch per Pass, Shuffled per Chunk, Instead of Random Data\n");
+    fprintf(stderr, "  -e epochs   Stop After This Epoch Even if the Error is Still Above Target (Default %d)\n", MaxIter);
+    fprintf(stderr, "  -c file     Save a Checkpoint of Weights and Progress When Training Stops\n");
+    fprintf(stderr, "  -i epochs   Also Checkpoint Every This Many Epochs, Written in the Background\n");
+    fprintf(stderr, "  -w seconds  Also Checkpoint When This Long Has Passed Since the Last, Written in the Background\n");
+    fprintf(stderr, "  -r file     Resume from a Checkpoint, Whose Topology, Precision, Tier and Seed Replace -l, -p, -a and -s\n");
+}
 
-    for (int i = 0; i < HiddenN; i++)   // For All Neurons in Hidden Layer
+// Driver Function
+int main(int argc, char *argv[])
+{
+    int widths[MaxLayers];
+    int n_widths = parseTopology(DefaultTopology, widths, MaxLayers);
+    int batch = 1;  // Samples per Training Step
+    int tier = SigmoidExact;
+    int bad_layout = 0;
+    WeightLayout layouts[2] = { LayoutPanels, LayoutPanels };  // Forward and Backward
+    int precision = PrecisionDouble;
+    int hogwild = 0;    // Asynchronous Per-Sample Updates Instead of Synchronous Steps
+    int deterministic = 0;  // Fixed Team Size and Reduction Order, Full Precision Trace
+    uint64_t seed = (uint64_t)time(0);  // Seed of All Generated Data, Weights and Shuffles
+    const char *data_path = NULL;       // Dataset to Train on, Random Data if NULL
+    int last_epoch = MaxIter;           // Epoch Training Stops After
+    const char *save_path = NULL;       // Checkpoint Written When Training Stops
+    int every_epochs = 0;               // Background Checkpoint Interval in Epochs, 0 for None
+    double every_seconds = 0;           // Background Checkpoint Interval in Seconds, 0 for None
+    const char *resume_path = NULL;     // Checkpoint to Resume From
+    int opt;
+
+    while ((opt = getopt(argc, argv, "l:b:a:L:p:t:s:HDd:e:c:i:w:r:")) != -1)
     {
-        DL1[i] = WL1[i][InN];            // Get Bias
-        for (int j = 0; j < InN; j++)    // From All Inputs
+        switch (opt)
         {
-            DL1[i] += (WL1[i][j] * in_vector[j]);
+            case 'l':
+                n_widths = parseTopology(optarg, widths, MaxLayers);
+                break;
+            case 'b':
+                batch = atoi(optarg);
+                break;
+            case 'a':
+                tier = parseSigmoidTier(optarg);
+                break;
+            case 'L':
+                bad_layout = (parseLayouts(optarg, &layouts[0], &layouts[1]) != 0);
+                break;
+            case 'p':
+                precision = parsePrecision(optarg);
+                break;
+            case 't':
+                omp_set_num_threads(atoi(optarg) > 0 ? atoi(optarg) : 1);
+                break;
+            case 's':
+                seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'H':
+                hogwild = 1;
+                break;
+            case 'D':
+                deterministic = 1;
+                break;
+            case 'd':
+                data_path = optarg;
+                break;
+            case 'e':
+                last_epoch = atoi(optarg);
+                break;
+            case 'c':
+                save_path = optarg;
+                break;
+            case 'i':
+                every_epochs = atoi(optarg);
+                break;
+            case 'w':
+                every_seconds = atof(optarg);
+                break;
+            case 'r':
+                resume_path = optarg;
+                break;
+            default:
+                printUsage(argv[0]);
+                return 1;
         }
+    }
 
-        OL1[i] = sigmoid(DL1[i]);       // Calculate Output from Sigmoid
+    if (n_widths == 0 || batch < 1 || tier < 0 || bad_layout || precision < 0 || last_epoch < 1 || every_epochs < 0 || every_seconds < 0 || (hogwild && deterministic))   // Hogwild Races by Design
+    {
+        printUsage(argv[0]);
+        return 1;
     }
 
-    // Forward Pass for Output Layer
+    TrainState state = { 0, seed, 1 };
+    Network *net = NULL;
 
-    for (int i = 0; i < OutN; i++)    // For All Neurons in Output Layer
+    if (resume_path != NULL)
     {
-        DL2[i] = WL2[i][HiddenN];           // Get Bias
-        for (int j = 0; j < HiddenN; j++)   // From All Neurons in Hidden Layer
+        // Pick Up Where the Checkpoint Left Off, Its Network and Seed Replace the Options
+        if ((net = loadCheckpoint(resume_path, &state)) == NULL)
         {
-            DL2[i] += (WL2[i][j] * OL1[j]);
+            fprintf(stderr, "Failed to Load Checkpoint %s!\n", resume_path);
+            return 1;
         }
 
-        OL2[i] = sigmoid(DL2[i]);       // Calculate Output from Sigmoid
+        seed = state.seed;
+        precision = net->precision;
+        n_widths = net->n_layers + 1;
+        for (int l = 0; l < n_widths; l++)
+            widths[l] = net->widths[l];
     }
-}
 
-// Function to Calculate Total Error in Network
-double calcError(void)
-{
-    double total_error = 0;
-    double temp_error;
-
-    for (int i = 0; i < OutN; i++)
+    if (precision != PrecisionDouble && batch > 1 && !hogwild)
     {
-        temp_error = out_vector[i] - OL2[i];
-        total_error += 0.5 * (temp_error * temp_error);
+        fprintf(stderr, "The All-Reduce Needs -p double, Use -H or -b 1 for float and Mixed!\n");
+        printUsage(argv[0]);
+        return 1;
     }
 
-    return total_error;
-}
+    // Every Pass Already Splits and Reduces in an Order Fixed by Thread Number,
+    // so Keeping the Runtime from Resizing the Team is All Determinism Needs
+    if (deterministic)
+        omp_set_dynamic(0);
 
-// Function to Train Neural Network
-void trainNN(void)
-{
-    double delta_out[OutN];
-    for (int i = 0; i < OutN; i++)
+    const int in_n = widths[0];
+    const int out_n = widths[n_widths - 1];
+
+    if (net == NULL)
+        net = createNN(widths, n_widths, learn_rate, (Precision)precision);
+
+    Workspace *ws = (net != NULL) ? createWorkspace(net, batch) : NULL;
+    double *in_vector = malloc((size_t)batch * in_n * sizeof(double));      // Training Input Vectors
+    double *out_vector = malloc((size_t)batch * out_n * sizeof(double));    // Training Output Vectors
+    const int n_threads = omp_get_max_threads();
+    Workspace **shard_ws = calloc(n_threads, sizeof(Workspace *));         // Per-Thread Mini-Batch Buffers
+    double **grads = calloc(n_threads, sizeof(double *));                   // Per-Thread Gradient Sums
+    double *shard_error = calloc(n_threads, sizeof(double));                // Per-Thread Hogwild Error Sums
+    Dataset *ds = NULL;
+    Prefetcher *pf = NULL;
+
+    if (ws == NULL || in_vector == NULL || out_vector == NULL || shard_ws == NULL || grads == NULL || shard_error == NULL)
     {
-        double error_out = (out_vector[i] - OL2[i]);
-        delta_out[i] = (error_out * dSigmoid(OL2[i]));
+        fprintf(stderr, "Failed to Allocate Network!\n");
+        return 1;
     }
 
-    double delta_hidden[HiddenN];
-    for (int i = 0; i < HiddenN; i++)
+    for (int t = 0; t < n_threads && batch > 1; t++)
     {
-        double error_hidden = 0.0f;
-        for (int j = 0; j < OutN; j++)
+        shard_ws[t] = createWorkspace(net, (batch < MiniBatch) ? batch : MiniBatch);
+        grads[t] = hogwild ? NULL : createGradient(net);
+
+        if (shard_ws[t] == NULL || (grads[t] == NULL && !hogwild))
         {
-            error_hidden += (delta_out[j] * WL2[j][i]); // TODO: Confirm Correct Indexing
+            fprintf(stderr, "Failed to Allocate Network!\n");
+            return 1;
         }
-
-        delta_hidden[i] = (error_hidden * dSigmoid(OL1[i]));
     }
 
-    // Update Output Layer Weights
+    if (data_path != NULL && (ds = openDataset(data_path, in_n, out_n, DefaultChunk)) == NULL)
+    {
+        fprintf(stderr, "Failed to Open Dataset %s with %d Inputs and %d Targets!\n", data_path, in_n, out_n);
+        return 1;
+    }
 
-    for (int i = 0; i < OutN; i++)                  // For All Neurons in Output Layer
+    // Chunks Are Read and Shuffled on a Producer Thread Outside the Team While the Previous One Trains
+    if (ds != NULL && (pf = createPrefetcher(ds, 1, seed, state.epoch + 1)) == NULL)
     {
-        WL2[i][HiddenN] += (delta_out[i] * learn_rate); // Update Bias
-        for (int j = 0; j < HiddenN; j++)               // Calculate New Weights from Hidden Layer Neurons
-        {
-            WL2[i][j] += (OL1[j] * delta_out[i]) * learn_rate;
-        }
+        fprintf(stderr, "Failed to Start Dataset Prefetch!\n");
+        return 1;
     }
 
-    // Update Hidden Layer Weights
+    if (resume_path == NULL)
+        net->sigmoid_tier = (SigmoidTier)tier;
+
+    net->forward_layout = layouts[0];
+    net->backward_layout = layouts[1];
+
+    // Periodic Checkpoints Cost the Team One Copy of the Weights, a Writer Thread Does the Rest
+    Checkpointer *cp = NULL;
 
-    for (int i = 0; i < HiddenN; i++)               // For All Neurons in Hidden Layer
+    if (save_path != NULL && (every_epochs > 0 || every_seconds > 0) &&
+        (cp = createCheckpointer(save_path, net, every_epochs, every_seconds)) == NULL)
     {
-        WL1[i][InN] += (delta_hidden[i] * learn_rate);  // Update Bias
-        for (int j = 0; j < InN; j++)                   // Calculate New Weights from Input
-        {
-            WL1[i][j] += (in_vector[j] * delta_hidden[i]) * learn_rate;
-        }
+        fprintf(stderr, "Failed to Start Checkpoint Writer!\n");
+        return 1;
     }
-}
 
-// Driver Function
-int main(void)
-{
-    srand(time(0));  // Create Seed for rand()
+    printf("Seed = %llu\n", (unsigned long long)seed);  // Print Seed to Reproduce This Run
 
     double total_error = 1;
-    int epoch = 1;
+    int epoch = (int)state.epoch + 1;
+    const int first_epoch = epoch;
+
+    if (resume_path != NULL)
+        printf("Resuming %s After Epoch %d, Error = %f\n", resume_path, epoch - 1, state.error);
 
-    // Generate Random Input
-    generateInput2();
+    if (ds == NULL && batch > 1)
+    {
+        // Generate Random Training Batch
+        generateBatch(in_vector, in_n, out_vector, out_n, batch, seed);
+    }
+    else if (ds == NULL)
+    {
+        // Generate Random Input
+        generateInput2(in_vector, in_n, seed);
 
-    // Generate Random Output
-    generateOutput2();
+        // Generate Random Output
+        generateOutput2(out_vector, out_n, seed);
 
-    // Print Generated Vectors
-    printInOut();
+        // Print Generated Vectors
+        printInOut(in_vector, in_n, out_vector, out_n);
+    }
 
     // Initialize Weights
-    initializeWeights2();
+    if (resume_path == NULL)
+        initializeWeights2(net, seed);
+
+    // Initial Network Activation and Error, a Dataset's Error Comes with Its First Epoch
+    if (ds == NULL)
+    {
+        if (batch > 1)
+            activateNNBatch(net, ws, in_vector, batch);
+        else
+            activateNN(net, ws, in_vector);
+
+        // Calculate Initial Error
+        total_error = (batch > 1) ? calcErrorBatch(net, ws, out_vector, batch) : calcError(net, ws, out_vector);
+
+        printf("Initial Error = %f!\n", total_error);   // Print Initial Activation Error
+    }
+
+    // Train Model, One Persistent Thread Team for the Whole Run
 
-    // Initial Network Activation
-    activateNN();
+#ifdef EBP_STATS
+    // Each Thread Times Its Own Shard Workspace, Split Passes Are Timed by Thread 0 Alone
+    StatsReporter rep;
+    PhaseStats *stats_of[n_threads];
 
-    // Calculate Initial Error
-    total_error = calcError();
+    for (int t = 0; t < n_threads; t++)
+        stats_of[t] = (batch > 1) ? shard_ws[t]->stats : ((t == 0) ? ws->stats : NULL);
 
-    printf("Initial Error = %f!\n", total_error);   // Print Initial Activation Error
+    startStats(&rep, stats_of, n_threads, StatsInterval, epoch);
+#endif
 
-    // Train Model
+    double start = omp_get_wtime();
+    int failed = 0;     // Dataset Error, Latched Inside single so Every Thread Stops at the Same Epoch
 
-    while (total_error > max_error)
+    #pragma omp parallel
     {
-        // Update Weights Using Error Back-Propagation
-        trainNN();
+        double step_error = 0;
+
+        while (total_error > max_error)     // Shared, Only Written Inside single Below
+        {
+            if (ds != NULL)
+            {
+                // One Pass over the Dataset, Chunk by Chunk
+                step_error = trainEpoch2(net, ws, shard_ws, grads, shard_error, pf, batch, hogwild);
+            }
+            else if (batch > 1 && hogwild)
+            {
+                // New Seeded Sample Order Each Pass, Then an Asynchronous Pass,
+                // Threads Only Meet Here to Check Convergence
+                #pragma omp single
+                shuffleSamples(in_vector, in_n, out_vector, out_n, batch, seed, epoch);
+
+                shard_error[omp_get_thread_num()] = trainNNHogwild(net, shard_ws[omp_get_thread_num()], in_vector, out_vector, batch);
+
+                #pragma omp barrier
+
+                step_error = 0;
+                for (int t = 0; t < omp_get_num_threads(); t++)
+                    step_error += shard_error[t] / batch;
+            }
+            else if (batch > 1)
+            {
+                // Data-Parallel Step, Each Thread Training on Its Shard of the Batch
+                // Gradients Are All-Reduced, so the Error is of the Weights Before This Update
+                step_error = trainNNData(net, shard_ws[omp_get_thread_num()], grads, in_vector, out_vector, batch);
+            }
+            else
+            {
+                // Update Weights Using Error Back-Propagation, Split Across the Team
+                trainNNTeam(net, ws, out_vector);
+
+                // Activate Neurons, Split Across the Team
+                activateNNTeam(net, ws, in_vector);
+            }
+
+            #pragma omp single
+            {
+                // Calculate New Error
+                total_error = (batch > 1 || ds != NULL) ? step_error : calcError(net, ws, out_vector);
+
+                if (deterministic)
+                    printf("Epoch %d - Error = %.17g!\n", epoch, total_error);  // Print Epoch Information
+
+                if (cp != NULL)
+                {
+                    // Snapshot the Weights if a Checkpoint is Due, They Hold Still While the Rest of the Team Waits
+                    state.epoch = (uint64_t)epoch;
+                    state.error = total_error;
+                    tickCheckpointer(cp, &state);
+                }
+
+#ifdef EBP_STATS
+                tickStats(&rep, epoch);
+#endif
+
+                failed = (pf != NULL && prefetchFailed(pf));
+
+                epoch++;    // Increment Epoch Variable
+            }
+
+            if (epoch > last_epoch || failed)
+            {
+                break;
+            }
+        }
+    }
+
+    if (failed)
+        fprintf(stderr, "Failed to Read Dataset %s!\n", data_path);
 
-        // Activate Neurons
-        activateNN();
+#ifdef EBP_STATS
+    finishStats(&rep, epoch - 1);
 
-        // Calculate New Error
-        total_error = calcError();
+    // Compare Each Phase's Achieved Rates Against This Machine's Measured Peaks
+    MachinePeaks peaks;
+    PhaseStats total;
 
-//        printf("Epoch %d - Error = %f!\n", epoch, total_error);  // Print Epoch Information
+    sumStats(&rep, &total);
 
-        epoch++;    // Increment Epoch Variable
+    if (probeMachine(net, &peaks) == 0)
+        printRoofline(net, (batch > 1) ? ((batch < MiniBatch) ? batch : MiniBatch) : 1, &total, &peaks);
+    else
+        fprintf(stderr, "Failed to Probe Machine Peaks!\n");
+#endif
 
-        if (epoch > MaxIter)
+    printf("Final Error was %f!\n", total_error);
+    printf("Trained %d Epochs in %f s (%s)\n", epoch - first_epoch, omp_get_wtime() - start,
+           (batch == 1) ? "team" : (hogwild ? "hogwild" : "all-reduce"));
+
+    if (pf != NULL)
+        printf("Waited %f s for Data\n", pf->wait);   // Training Stalled on the Prefetcher This Long
+
+    if (cp != NULL)
+    {
+        stopCheckpointer(cp);
+        printf("Checkpoints: %d Taken, %d Skipped While Writing, %d Failed, %zu Bytes Each\n", cp->taken, cp->skipped,
+               cp->failed, cp->bytes);
+        printf("Training Stalled %f ms Mean, %f ms Max per Checkpoint, Writer Took %f ms Mean\n",
+               cp->taken ? cp->stall * 1e3 / cp->taken : 0.0, cp->stall_max * 1e3,
+               (cp->written + cp->failed) ? cp->write * 1e3 / (cp->written + cp->failed) : 0.0);
+        freeCheckpointer(cp);
+    }
+
+    if (save_path != NULL && !failed)
+    {
+        state.epoch = (uint64_t)(epoch - 1);
+        state.seed = seed;
+        state.error = total_error;
+
+        if (saveCheckpoint(save_path, net, &state) != 0)
         {
-            break;
+            fprintf(stderr, "Failed to Save Checkpoint %s!\n", save_path);
+            return 1;
         }
+
+        printf("Saved Checkpoint %s After Epoch %d\n", save_path, epoch - 1);
     }
 
-    printf("Final Error was %f!", total_error);
+    for (int t = 0; t < n_threads; t++)
+    {
+        freeWorkspace(shard_ws[t]);
+        freeGradient(grads[t]);
+    }
 
-    return 0;
-}
\ No newline at end of file
+    freePrefetcher(pf);
+    closeDataset(ds);
+    free(shard_ws);
+    free(grads);
+    free(shard_error);
+    free(in_vector);
+    free(out_vector);
+    freeWorkspace(ws);
+    freeNN(net);
+
+    return failed;
+}
@@ -0,0 +1,173 @@
+// ********************************************************************************
+// Inline Layer Kernels Shared by the Generic and Fixed-Size Network Paths
+// ********************************************************************************
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <string.h>
+
+#include "network.h"
+
+// Kernels Are Always Inlined, so When Called with Constant Sizes from network_fixed.c
+// the Compiler Sees Fixed Trip Counts and Can Fully Unroll and Vectorize Each Loop
+#define KernelInline static inline __attribute__((always_inline))
+
+// Columns per Block of the Fused Backward Sweep, Whose Errors and Inputs Then Take 4 KiB of L1
+#define BackBlock 256
+
+// One Cache Line of Doubles as a Single Vector Value, Lowered to Whatever
+// Vector Width the Function Using It is Compiled For
+typedef double LineVec __attribute__((vector_size(CacheLine)));
+typedef double HalfVec __attribute__((vector_size(CacheLine / 2)));
+typedef double QuarterVec __attribute__((vector_size(CacheLine / 4)));
+
+// Helper Function to Sum the Lanes of a Line as a Tree of Vector Adds
+// The Halves Are Split with memcpy, Which the Compiler Turns into Register Extracts
+KernelInline double lineSum(const LineVec *v)
+{
+    HalfVec h0, h1;
+    QuarterVec q0, q1;
+
+    memcpy(&h0, v, sizeof(HalfVec));
+    memcpy(&h1, (const char *)v + sizeof(HalfVec), sizeof(HalfVec));
+    h0 += h1;
+
+    memcpy(&q0, &h0, sizeof(QuarterVec));
+    memcpy(&q1, (const char *)&h0 + sizeof(QuarterVec), sizeof(QuarterVec));
+    q0 += q1;
+
+    return q0[0] + q0[1];
+}
+
+// Helper Function to Forward One Layer, One Padded Dot Product per Neuron
+KernelInline void forwardLayer(const double *restrict W, int stride, int out, SigmoidTier tier,
+                               const double *restrict x, double *restrict D, double *restrict O)
+{
+    W = __builtin_assume_aligned(W, CacheLine);
+    x = __builtin_assume_aligned(x, CacheLine);
+
+    const LineVec *xv = (const LineVec *)x;
+    const int lines = stride / PadN;
+    int i = 0;
+
+    // Four Neurons at a Time, so Each Line of x Feeds Four Products
+
+    for (; i + 4 <= out; i += 4)
+    {
+        const LineVec *w0 = (const LineVec *)(W + (size_t)i * stride);
+        const LineVec *w1 = w0 + lines;
+        const LineVec *w2 = w1 + lines;
+        const LineVec *w3 = w2 + lines;
+        LineVec a0 = { 0.0 }, a1 = { 0.0 }, a2 = { 0.0 }, a3 = { 0.0 };
+
+        for (int j = 0; j < lines; j++)     // From All Inputs, Bias Slot and Padding
+        {
+            a0 += w0[j] * xv[j];
+            a1 += w1[j] * xv[j];
+            a2 += w2[j] * xv[j];
+            a3 += w3[j] * xv[j];
+        }
+
+        D[i] = lineSum(&a0);
+        D[i + 1] = lineSum(&a1);
+        D[i + 2] = lineSum(&a2);
+        D[i + 3] = lineSum(&a3);
+    }
+
+    for (; i < out; i++)
+    {
+        const LineVec *w = (const LineVec *)(W + (size_t)i * stride);
+        LineVec a = { 0.0 };
+
+        for (int j = 0; j < lines; j++)
+            a += w[j] * xv[j];
+
+        D[i] = lineSum(&a);
+    }
+
+    sigmoidLayer(tier, D, O, out);          // Calculate Outputs from Sigmoid, Whole Layer at Once
+}
+
+// Helper Function to Calculate Output Layer Deltas
+KernelInline void outputDeltas(int out, const double *restrict target,
+                               const double *restrict O, double *restrict delta)
+{
+    for (int i = 0; i < out; i++)
+    {
+        double error_out = (target[i] - O[i]);
+        delta[i] = (error_out * dSigmoid(O[i]));
+    }
+}
+
+// Helper Function to Back-Propagate a Layer's Deltas and Update Its Weights in One Sweep over Columns [b, e)
+// Each Weight is Read for the Error of Its Input, Then Updated in Place, so W Streams Through the
+// Cache Once per Step Instead of Twice, and Always Along Its Rows, Never Down a Column
+// Columns Go in Blocks of BackBlock, so a Block's Errors and Inputs Stay in L1 While Every Row Passes
+// b and e Are Multiples of PadN, err Receives the Raw Errors of Columns [b, e) for finishDeltas()
+KernelInline void backpropLayer(double *restrict W, int stride, int out, int b, int e,
+                                const double *restrict delta_next, const double *restrict x,
+                                double *restrict err, double rate)
+{
+    const LineVec *xv = __builtin_assume_aligned(x, CacheLine);
+    LineVec *ev = __builtin_assume_aligned(err, CacheLine);
+
+    for (int j0 = b / PadN; j0 < e / PadN; j0 += BackBlock / PadN)
+    {
+        const int j1 = (j0 + BackBlock / PadN < e / PadN) ? j0 + BackBlock / PadN : e / PadN;
+
+        for (int j = j0; j < j1; j++)
+            ev[j] = (LineVec){ 0.0 };
+
+        for (int i = 0; i < out; i++)
+        {
+            LineVec *w = __builtin_assume_aligned(W + (size_t)i * stride, CacheLine);
+            const double d = delta_next[i];
+            const double u = d * rate;
+
+            for (int j = j0; j < j1; j++)
+            {
+                const LineVec old = w[j];   // Read Before the Write Below
+
+                ev[j] += old * d;
+                w[j] = old + xv[j] * u;
+            }
+        }
+    }
+}
+
+// Helper Function to Turn the Raw Errors of Columns [b, e) into Deltas, in Place
+// Only the in Real Inputs Get Deltas, the Bias Slot and Padding Are Cleared
+KernelInline void finishDeltas(double *restrict delta, const double *restrict O, int b, int e, int in)
+{
+    for (int j = b; j < e; j++)
+        delta[j] = (j < in) ? delta[j] * dSigmoid(O[j]) : 0.0;
+}
+
+// Helper Function to Update Layer Weights, Bias Included Through the Bias Slot of x
+// Whole Lines Are Updated, the Zero Padding of x Leaving the Padding of W at Zero
+KernelInline void updateLayer(double *restrict W, int stride, int out,
+                              const double *restrict x, const double *restrict delta, double rate)
+{
+    const LineVec *xv = __builtin_assume_aligned(x, CacheLine);
+    const int lines = stride / PadN;
+
+    for (int i = 0; i < out; i++)
+    {
+        LineVec *w = __builtin_assume_aligned(W + (size_t)i * stride, CacheLine);
+        double d = delta[i] * rate;
+
+        for (int j = 0; j < lines; j++)
+            w[j] += xv[j] * d;
+    }
+}
+
+// Function to Bind Fixed-Size Kernels if the Topology Has a Specialization
+int bindFixedKernels(Network *net);
+
+// float and Mixed Precision Passes, in network_float.c
+void bindFloatKernels(Network *net);
+void activateNNBatchFloat(const Network *net, Workspace *ws, const double *in, int batch);
+void trainNNBatchFloat(Network *net, Workspace *ws, const double *target, int batch);
+
+#endif
@@ -0,0 +1,950 @@
+// ********************************************************************************
+// Runtime-Configurable Error Back - Propagation Neural Network
+// ********************************************************************************
+
+#define _POSIX_C_SOURCE 200112L
+
+// Include Libraries
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include <stdint.h>
+
+#include "network.h"
+#include "kernels.h"
+#include "rng.h"
+
+// Definitions - Macros
+#define BlockS 8
+#define BlockN 32
+#define BlockK 64
+#define PanelK 256      // Panel Rows per Block, 16 KiB of Panel Staying in L1 While the Batch Passes
+#define PanelRows 8     // Samples per Panel GEMM Step, Each Accumulating One Line, Smaller Batches Read W by Rows
+#define PackMinBatch 16 // Samples a Forward Call Needs to Repay Packing Its Panels
+
+// Passes Built on the Line Kernels Are Cloned for the Baseline, AVX2+FMA and AVX-512 Levels
+#define ClonedTargets __attribute__((target_clones("default", "arch=x86-64-v3", "arch=x86-64-v4")))
+
+#ifdef EBP_STATS
+#define StatsBytes (((sizeof(PhaseStats) + CacheLine - 1) / CacheLine) * CacheLine)
+#else
+#define StatsBytes 0
+#endif
+
+static const char *precision_names[Precisions] = { "double", "float", "mixed" };
+static const char *layout_names[Layouts] = { "rows", "panels" };
+
+// *******************************************************************
+#pragma GCC optimize("O3","unroll-loops","omit-frame-pointer","inline", "unsafe-math-optimizations")
+//************************************************************
+
+// ***********************************
+// Helper Functions
+// ***********************************
+
+// Helper Function to Generate Random Weight, index Being Its Position in the Weight Arena
+double initWeight(uint64_t seed, size_t index)
+{
+    return rngUniform(seed, RngWeights, index);
+}
+
+// Helper Function to Get Padded Length of a Width Plus Its Bias Slot
+int paddedStride(int n)
+{
+    return ((n + 1 + PadN - 1) / PadN) * PadN;
+}
+
+// Helper Function to Parse a Topology Such as "12,100,10" into Layer Widths
+// Returns Number of Widths, or 0 if the Specification is Invalid
+int parseTopology(const char *spec, int *widths, int max_widths)
+{
+    int n = 0;
+    const char *p = spec;
+
+    while (*p)
+    {
+        char *end;
+        long w = strtol(p, &end, 10);
+
+        if (end == p || w < 1 || n == max_widths)
+            return 0;
+
+        widths[n++] = (int)w;
+
+        if (*end == ',')
+            end++;
+        else if (*end != '\0')
+            return 0;
+
+        p = end;
+    }
+
+    return (n >= 2) ? n : 0;
+}
+
+// Helper Function to Get the Name of a Precision
+const char *precisionName(Precision precision)
+{
+    return (precision >= 0 && precision < Precisions) ? precision_names[precision] : "unknown";
+}
+
+// Helper Function to Parse a Precision Name, Returns -1 if Unknown
+int parsePrecision(const char *name)
+{
+    for (int p = 0; p < Precisions; p++)
+        if (strcmp(name, precision_names[p]) == 0)
+            return p;
+
+    return -1;
+}
+
+// Helper Function to Get the Name of a Weight Layout
+const char *layoutName(WeightLayout layout)
+{
+    return (layout >= 0 && layout < Layouts) ? layout_names[layout] : "unknown";
+}
+
+// Helper Function to Parse a Weight Layout Name, Returns -1 if Unknown
+int parseLayout(const char *name)
+{
+    for (int l = 0; l < Layouts; l++)
+        if (strcmp(name, layout_names[l]) == 0)
+            return l;
+
+    return -1;
+}
+
+// Helper Function to Parse "forward[,backward]" Layout Names, the One Name Serving Both if Alone
+// Returns 0, or -1 Leaving Both Untouched if a Name is Unknown
+int parseLayouts(const char *spec, WeightLayout *forward, WeightLayout *backward)
+{
+    char name[32];
+    const char *comma = strchr(spec, ',');
+    const size_t n = (comma != NULL) ? (size_t)(comma - spec) : strlen(spec);
+
+    if (n >= sizeof(name))
+        return -1;
+
+    memcpy(name, spec, n);
+    name[n] = '\0';
+
+    const int f = parseLayout(name);
+    const int b = (comma != NULL) ? parseLayout(comma + 1) : f;
+
+    if (f < 0 || b < 0)
+        return -1;
+
+    *forward = (WeightLayout)f;
+    *backward = (WeightLayout)b;
+
+    return 0;
+}
+
+// Helper Function to Swap Two Rows of n Doubles
+static void swapRows(double *a, double *b, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        double t = a[i];
+        a[i] = b[i];
+        b[i] = t;
+    }
+}
+
+// Helper Function to Shuffle Samples in Place, Input and Target Rows Together
+// Fisher-Yates Driven by (seed, round), so the Same Round Always Gives the Same Order
+void shuffleSamples(double *in, int in_n, double *target, int out_n, int n_samples, uint64_t seed, uint64_t round)
+{
+    for (int i = n_samples - 1; i > 0; i--)
+    {
+        int j = (int)(rngUniform(seed, RngShuffle, round * n_samples + i) * (i + 1));
+
+        swapRows(in + (size_t)i * in_n, in + (size_t)j * in_n, in_n);
+        swapRows(target + (size_t)i * out_n, target + (size_t)j * out_n, out_n);
+    }
+}
+
+// Helper Function to Allocate Zeroed, Cache Line Aligned Memory, Released with free()
+// Rounded Up to Whole Lines, so No Other Allocation Shares a Line with It
+void *alignedAlloc(size_t bytes)
+{
+    void *p = NULL;
+
+    bytes = ((bytes + CacheLine - 1) / CacheLine) * CacheLine;
+
+    if (posix_memalign(&p, CacheLine, bytes) != 0)
+        return NULL;
+
+    memset(p, 0, bytes);
+
+    return p;
+}
+
+// ***********************************
+// Blocked GEMM Kernels
+// ***********************************
+
+// Blocked GEMM, C[M][N] += A[M][K] * B[N][K]^T
+// A Tile of B Stays in Cache While All Rows of A Stream Past It, Each Entry of
+// the Tile Being One SIMD Dot Product over the Block Depth
+static void gemmNT(const SimdKernels *simd, int M, int N, int K, const double *A, int lda, const double *B, int ldb, double *C, int ldc)
+{
+    for (int j0 = 0; j0 < N; j0 += BlockN)
+    {
+        int j1 = (j0 + BlockN < N) ? j0 + BlockN : N;
+
+        for (int k0 = 0; k0 < K; k0 += BlockK)
+        {
+            int k1 = (k0 + BlockK < K) ? k0 + BlockK : K;
+
+            for (int i0 = 0; i0 < M; i0 += BlockS)
+            {
+                int i1 = (i0 + BlockS < M) ? i0 + BlockS : M;
+
+                for (int i = i0; i < i1; i++)
+                {
+                    for (int j = j0; j < j1; j++)
+                        C[(size_t)i * ldc + j] += simd->dot(A + (size_t)i * lda + k0, B + (size_t)j * ldb + k0, k1 - k0);
+                }
+            }
+        }
+    }
+}
+
+// Blocked GEMM, C[M][N] += A[M][K] * B[K][N]
+ClonedTargets static void gemmNN(int M, int N, int K, const double *A, int lda, const double *B, int ldb, double *C, int ldc)
+{
+    for (int k0 = 0; k0 < K; k0 += BlockK)
+    {
+        int k1 = (k0 + BlockK < K) ? k0 + BlockK : K;
+
+        for (int j0 = 0; j0 < N; j0 += BlockN)
+        {
+            int j1 = (j0 + BlockN < N) ? j0 + BlockN : N;
+
+            for (int i = 0; i < M; i++)
+            {
+                for (int k = k0; k < k1; k++)
+                {
+                    double a = A[(size_t)i * lda + k];
+                    for (int j = j0; j < j1; j++)
+                        C[(size_t)i * ldc + j] += a * B[(size_t)k * ldb + j];
+                }
+            }
+        }
+    }
+}
+
+// Blocked GEMM, C[M][N] += alpha * A[K][M]^T * B[K][N]
+ClonedTargets static void gemmTN(int M, int N, int K, double alpha, const double *A, int lda, const double *B, int ldb, double *C, int ldc)
+{
+    for (int k0 = 0; k0 < K; k0 += BlockS)
+    {
+        int k1 = (k0 + BlockS < K) ? k0 + BlockS : K;
+
+        for (int i = 0; i < M; i++)
+        {
+            for (int k = k0; k < k1; k++)
+            {
+                double a = alpha * A[(size_t)k * lda + i];
+                for (int j = 0; j < N; j++)
+                    C[(size_t)i * ldc + j] += a * B[(size_t)k * ldb + j];
+            }
+        }
+    }
+}
+
+// Helper Function to Multiply Into Whole Lines, C[rows][PadN] += A[rows][K] * B[K][PadN]
+// Row k of the Panel B is the Aligned Line at B + k * ldb, so Every Load is Unit-Stride, and
+// Each of Its Lines Feeds rows Accumulators Kept in Registers Across All of K
+static inline __attribute__((always_inline)) void panelKernel(const int rows, int K, const double *restrict A, int lda,
+                                                              const double *restrict B, int ldb, double *restrict C, int ldc)
+{
+    LineVec acc[PanelRows];
+
+    for (int r = 0; r < rows; r++)
+        acc[r] = *(LineVec *)__builtin_assume_aligned(C + (size_t)r * ldc, CacheLine);
+
+    for (int k = 0; k < K; k++)
+    {
+        const LineVec b = *(const LineVec *)__builtin_assume_aligned(B + (size_t)k * ldb, CacheLine);
+
+        for (int r = 0; r < rows; r++)
+            acc[r] += A[(size_t)r * lda + k] * b;
+    }
+
+    for (int r = 0; r < rows; r++)
+        *(LineVec *)__builtin_assume_aligned(C + (size_t)r * ldc, CacheLine) = acc[r];
+}
+
+// Blocked GEMM over Panels, C[M][N] += A[M][K] * B[K][N], N a Multiple of PadN
+// Panel p Holds Columns [p * PadN, (p + 1) * PadN) of B, Its Row k at B + p * panel_step + k * ldb,
+// and PanelK of Its Rows Stay in L1 While Every Row of A Passes in Groups of PanelRows
+ClonedTargets static void gemmPanels(int M, int N, int K, const double *A, int lda, const double *B, int ldb,
+                                     size_t panel_step, double *C, int ldc)
+{
+    for (int k0 = 0; k0 < K; k0 += PanelK)
+    {
+        const int kn = (k0 + PanelK < K) ? PanelK : K - k0;
+
+        for (int p = 0; p < N / PadN; p++)
+        {
+            const double *Bp = B + p * panel_step + (size_t)k0 * ldb;
+            double *Cp = C + (size_t)p * PadN;
+            int i = 0;
+
+            for (; i + PanelRows <= M; i += PanelRows)
+                panelKernel(PanelRows, kn, A + (size_t)i * lda + k0, lda, Bp, ldb, Cp + (size_t)i * ldc, ldc);
+
+            for (; i + PanelRows / 2 <= M; i += PanelRows / 2)
+                panelKernel(PanelRows / 2, kn, A + (size_t)i * lda + k0, lda, Bp, ldb, Cp + (size_t)i * ldc, ldc);
+
+            for (; i < M; i++)
+                panelKernel(1, kn, A + (size_t)i * lda + k0, lda, Bp, ldb, Cp + (size_t)i * ldc, ldc);
+        }
+    }
+}
+
+// Helper Function to Get the Neurons of a Layer Rounded Up to Whole Panels
+static int panelWidth(const Layer *layer)
+{
+    return ((layer->out + PadN - 1) / PadN) * PadN;
+}
+
+// Helper Function to Pack a Layer's Weights Transposed into Panels for the Forward gemmPanels()
+// Panel p Holds Inputs 0 to in (the Bias) of Neurons [p * PadN, (p + 1) * PadN), One Line per Input,
+// Neurons Past out Being Zero, so the Batch Then Streams Each Panel Front to Back
+// Each Panel is Written Line by Line While Its PadN Rows of W Are Read Side by Side, Once Each
+ClonedTargets static void packPanels(const Layer *layer, double *pack)
+{
+    const int K = layer->in + 1;
+
+    for (int p = 0; p < panelWidth(layer) / PadN; p++)
+    {
+        const int rows = (layer->out - p * PadN < PadN) ? layer->out - p * PadN : PadN;
+        const double *W = layer->W + (size_t)p * PadN * layer->stride;
+        double *panel = pack + (size_t)p * K * PadN;
+
+        for (int k0 = 0; k0 < K; k0 += PadN)
+        {
+            const int kn = (k0 + PadN < K) ? PadN : K - k0;
+            double block[PadN][PadN] = { { 0.0 } };
+
+            // A PadN by PadN Tile, Read Along the Rows and Written Back Along the Panel Lines
+
+            for (int n = 0; n < rows; n++)
+                for (int k = 0; k < PadN; k++)
+                    block[k][n] = W[(size_t)n * layer->stride + k0 + k];
+
+            memcpy(panel + (size_t)k0 * PadN, block, (size_t)kn * PadN * sizeof(double));
+        }
+    }
+}
+
+// Helper Function to Count the doubles of the Largest Layer's Forward Panels
+static size_t packDoubles(const Network *net)
+{
+    size_t most = 0;
+
+    for (int l = 0; l < net->n_layers; l++)
+    {
+        const size_t n = (size_t)panelWidth(&net->layers[l]) * (net->layers[l].in + 1);
+
+        most = (n > most) ? n : most;
+    }
+
+    return most;
+}
+
+// ***********************************
+// Construction and Destruction
+// ***********************************
+
+// Helper Function to Lay Out a Network's Layers Back to Back, Each Row Starting on a Cache Line
+// Fills Everything but the Arena Pointers, Returns -1 for an Invalid Topology or Precision,
+// Including One Whose Padded Strides or Arena (Plus a Padding Row of doubles) Would Overflow
+static int layoutNN(Network *net, const int *widths, int n_widths, double learn_rate, Precision precision)
+{
+    if (n_widths < 2 || n_widths > MaxLayers || precision < 0 || precision >= Precisions)
+        return -1;
+
+    memset(net, 0, sizeof(*net));
+
+    net->n_layers = n_widths - 1;
+    net->learn_rate = learn_rate;
+    net->precision = precision;
+    net->simd = simdKernels();
+    net->forward_layout = LayoutPanels;
+    net->backward_layout = LayoutPanels;
+
+    for (int l = 0; l < n_widths; l++)
+        net->widths[l] = widths[l];
+
+    for (int l = 0; l < net->n_layers; l++)
+    {
+        Layer *layer = &net->layers[l];
+
+        if (widths[l] < 1 || widths[l + 1] < 1 || widths[l] > INT_MAX - PadN)
+            return -1;
+
+        layer->in = widths[l];
+        layer->out = widths[l + 1];
+        layer->stride = paddedStride(widths[l]);
+        layer->offset = net->n_weights;
+
+        const size_t rows = (size_t)layer->out * layer->stride;
+
+        if (rows > SIZE_MAX / sizeof(double) - PadN - net->n_weights)
+            return -1;
+
+        net->n_weights += rows;
+    }
+
+    return 0;
+}
+
+// Helper Function to Point a Laid Out Network at Its Zeroed Weight Arena and Bind Its Kernels
+// Only the Arena of the Network's Precision Exists, Same Layout in Either
+static void bindArena(Network *net, void *arena)
+{
+    if (net->precision == PrecisionDouble)
+        net->weights = arena;
+    else
+        net->weights_f = arena;
+
+    for (int l = 0; l < net->n_layers; l++)
+    {
+        if (net->weights != NULL)
+            net->layers[l].W = net->weights + net->layers[l].offset;
+        else
+            net->layers[l].Wf = net->weights_f + net->layers[l].offset;
+    }
+
+    // Pick Fully Unrolled Kernels When This Shape Has Them, Generic Loops Otherwise
+    if (net->precision == PrecisionDouble)
+        bindFixedKernels(net);
+    else
+        bindFloatKernels(net);
+}
+
+// Helper Function to Get the Bytes of a Laid Out Network's Weight Arena
+static size_t arenaBytes(const Network *net)
+{
+    return net->n_weights * ((net->precision == PrecisionDouble) ? sizeof(double) : sizeof(float));
+}
+
+// Function to Create a Network with the Given Layer Widths, Input Layer First
+Network *createNN(const int *widths, int n_widths, double learn_rate, Precision precision)
+{
+    Network *net = alignedAlloc(sizeof(Network));
+    if (net == NULL)
+        return NULL;
+
+    void *arena = NULL;
+
+    if (layoutNN(net, widths, n_widths, learn_rate, precision) != 0 || (arena = alignedAlloc(arenaBytes(net))) == NULL)
+    {
+        free(net);
+        return NULL;
+    }
+
+    bindArena(net, arena);
+
+    return net;
+}
+
+// Function to Get the Bytes of Weight Arena initNN() Needs, 0 for an Invalid Topology or Precision
+size_t networkBytes(const int *widths, int n_widths, Precision precision)
+{
+    Network net;
+
+    if (layoutNN(&net, widths, n_widths, 0.0, precision) != 0)
+        return 0;
+
+    return arenaBytes(&net);
+}
+
+// Function to Build a Network in Caller-Owned Memory, Returns 0 on Success
+int initNN(Network *net, const int *widths, int n_widths, double learn_rate, Precision precision, void *buf)
+{
+    if (((uintptr_t)buf % CacheLine) != 0 || layoutNN(net, widths, n_widths, learn_rate, precision) != 0)
+        return -1;
+
+    memset(buf, 0, arenaBytes(net));
+    bindArena(net, buf);
+
+    return 0;
+}
+
+// Function to Release a Network
+void freeNN(Network *net)
+{
+    if (net == NULL)
+        return;
+
+    free(net->weights);
+    free(net->weights_f);
+    free(net);
+}
+
+// Helper Function to Count the doubles of a Workspace, Also Filling Its Layer Strides
+static size_t workspaceDoubles(const Network *net, int batch_cap, int *ld)
+{
+    size_t total = 0;
+
+    for (int l = 0; l <= net->n_layers; l++)
+    {
+        ld[l] = paddedStride(net->widths[l]);
+
+        total += ld[l] * (size_t)(1 + batch_cap);                   // O and OB
+        if (l > 0)
+            total += 2 * (size_t)ld[l] * (1 + batch_cap);           // D, delta, DB and deltaB
+    }
+
+    return total;
+}
+
+// Function to Get the Bytes of Arena initWorkspace() Needs for Up to batch_cap Samples
+// float and Mixed Networks Add float Buffers After the double Ones, in the Same Block,
+// Double Ones Room for Forward Panels if They Batch PackMinBatch or More,
+// and With EBP_STATS the Phase Timers Take the Last Cache Line
+size_t workspaceBytes(const Network *net, int batch_cap)
+{
+    int ld[MaxLayers];
+    const size_t total = workspaceDoubles(net, (batch_cap < 1) ? 1 : batch_cap, ld);
+
+    if (net->precision == PrecisionDouble)
+        return (total + ((batch_cap >= PackMinBatch) ? packDoubles(net) : 0)) * sizeof(double) + StatsBytes;
+
+    return total * sizeof(double) + ((total * sizeof(float) + CacheLine - 1) / CacheLine) * CacheLine + StatsBytes;
+}
+
+// Function to Build Activation Buffers in Caller-Owned Memory, Returns 0 on Success
+int initWorkspace(Workspace *ws, const Network *net, int batch_cap, void *buf)
+{
+    if (((uintptr_t)buf % CacheLine) != 0)
+        return -1;
+
+    if (batch_cap < 1)
+        batch_cap = 1;
+
+    memset(ws, 0, sizeof(*ws));
+    memset(buf, 0, workspaceBytes(net, batch_cap));
+
+    ws->n_layers = net->n_layers;
+    ws->batch_cap = batch_cap;
+
+    const size_t total = workspaceDoubles(net, batch_cap, ws->ld);
+
+    ws->arena = buf;
+    if (net->precision != PrecisionDouble)
+        ws->arena_f = (float *)(ws->arena + total);
+    else if (batch_cap >= PackMinBatch)
+        ws->pack = ws->arena + total;
+#ifdef EBP_STATS
+    ws->stats = (PhaseStats *)((char *)buf + workspaceBytes(net, batch_cap) - StatsBytes);
+#endif
+
+    double *p = ws->arena;
+    for (int l = 0; l <= net->n_layers; l++)
+    {
+        size_t single = ws->ld[l];
+        size_t batched = ws->ld[l] * (size_t)batch_cap;
+
+        ws->O[l] = p;       p += single;
+        ws->OB[l] = p;      p += batched;
+
+        if (l > 0)
+        {
+            ws->D[l - 1] = p;       p += single;
+            ws->delta[l - 1] = p;   p += single;
+            ws->DB[l - 1] = p;      p += batched;
+            ws->deltaB[l - 1] = p;  p += batched;
+        }
+
+        // Set Bias Slots Once, Padding Stays Zero
+
+        ws->O[l][net->widths[l]] = 1.0;
+        for (int b = 0; b < batch_cap; b++)
+            ws->OB[l][(size_t)b * ws->ld[l] + net->widths[l]] = 1.0;
+    }
+
+    // float Buffers at the Same Offsets in Their Own Region
+
+    for (int l = 0; l <= net->n_layers && ws->arena_f != NULL; l++)
+    {
+        ws->Of[l] = ws->arena_f + (ws->O[l] - ws->arena);
+        ws->OBf[l] = ws->arena_f + (ws->OB[l] - ws->arena);
+
+        if (l > 0)
+        {
+            ws->Df[l - 1] = ws->arena_f + (ws->D[l - 1] - ws->arena);
+            ws->deltaf[l - 1] = ws->arena_f + (ws->delta[l - 1] - ws->arena);
+            ws->DBf[l - 1] = ws->arena_f + (ws->DB[l - 1] - ws->arena);
+            ws->deltaBf[l - 1] = ws->arena_f + (ws->deltaB[l - 1] - ws->arena);
+        }
+
+        ws->Of[l][net->widths[l]] = 1.0f;
+        for (int b = 0; b < batch_cap; b++)
+            ws->OBf[l][(size_t)b * ws->ld[l] + net->widths[l]] = 1.0f;
+    }
+
+    return 0;
+}
+
+// Function to Create Activation Buffers for a Network, Sized for Up to batch_cap Samples
+Workspace *createWorkspace(const Network *net, int batch_cap)
+{
+    Workspace *ws = alignedAlloc(sizeof(Workspace));
+    void *arena = alignedAlloc(workspaceBytes(net, batch_cap));
+
+    if (ws == NULL || arena == NULL || initWorkspace(ws, net, batch_cap, arena) != 0)
+    {
+        free(arena);
+        free(ws);
+        return NULL;
+    }
+
+    return ws;
+}
+
+// Function to Release a Workspace, Its float Buffers Share the Block of the double Ones
+void freeWorkspace(Workspace *ws)
+{
+    if (ws == NULL)
+        return;
+
+    free(ws->arena);
+    free(ws);
+}
+
+// Function to Create a Zeroed Gradient Arena with the Layout of the Network's Weights
+// One Extra Cache Line at the End Carries an Error Sum Along with the Gradient
+double *createGradient(const Network *net)
+{
+    return alignedAlloc((net->n_weights + PadN) * sizeof(double));
+}
+
+// Function to Release a Gradient Arena
+void freeGradient(double *grad)
+{
+    free(grad);
+}
+
+// Function to Initialize All Weights Using initWeight
+// Weights Depend Only on Their Arena Position, so Every Precision Starts from the Same Values
+void initializeWeights(Network *net, uint64_t seed)
+{
+    for (int l = 0; l < net->n_layers; l++)
+    {
+        Layer *layer = &net->layers[l];
+
+        for (int i = 0; i < layer->out; i++)
+        {
+            size_t row = layer->offset + (size_t)i * layer->stride;
+
+            for (int j = 0; j <= layer->in; j++)
+            {
+                double w = (j == layer->in) ? 1 : initWeight(seed, row + j);     // Add Bias
+
+                if (layer->Wf != NULL)
+                    layer->Wf[row - layer->offset + j] = (float)w;
+                else
+                    layer->W[row - layer->offset + j] = w;
+            }
+        }
+    }
+}
+
+// ***********************************
+// Single Sample Passes
+// ***********************************
+
+// Function to Activate Neural Network
+void activateNN(const Network *net, Workspace *ws, const double *in)
+{
+    StatBegin(t0);
+
+    memcpy(ws->O[0], in, net->widths[0] * sizeof(double));
+
+    if (net->activate != NULL)
+    {
+        net->activate(net, ws);
+        StatEnd(ws->stats, PhaseForward, t0);
+        return;
+    }
+
+    for (int l = 0; l < net->n_layers; l++)    // For All Layers, Input Side First
+    {
+        const Layer *layer = &net->layers[l];
+
+        net->simd->gemv(layer->W, layer->stride, layer->out, ws->O[l], layer->stride, ws->D[l]);
+        sigmoidLayer(net->sigmoid_tier, ws->D[l], ws->O[l + 1], layer->out);
+    }
+
+    StatEnd(ws->stats, PhaseForward, t0);
+}
+
+// Function to Get Output Layer Values of Last Activation
+const double *outputNN(const Network *net, const Workspace *ws)
+{
+    return ws->O[net->n_layers];
+}
+
+// Function to Calculate Total Error in Network
+double calcError(const Network *net, const Workspace *ws, const double *target)
+{
+    const double *out = ws->O[net->n_layers];
+    double total_error = 0;
+    double temp_error;
+
+    StatBegin(t0);
+
+    for (int i = 0; i < net->widths[net->n_layers]; i++)
+    {
+        temp_error = target[i] - out[i];
+        total_error += 0.5 * (temp_error * temp_error);
+    }
+
+    StatEnd(ws->stats, PhaseError, t0);
+
+    return total_error;
+}
+
+// Helper Function to Back-Propagate Hidden Deltas and Update Every Layer, Last Layer First
+// Each Hidden Layer's Deltas Come from the Weights Above in the Same Sweep That Updates Them,
+// Every Weight Being Read Before It is Written, so No Layer Sees Another's Updated Weights
+ClonedTargets static void backwardNN(Network *net, Workspace *ws)
+{
+    for (int l = net->n_layers - 1; l > 0; l--)
+    {
+        Layer *layer = &net->layers[l];
+
+        backpropLayer(layer->W, layer->stride, layer->out, 0, layer->stride, ws->delta[l], ws->O[l], ws->delta[l - 1],
+                      net->learn_rate);
+        finishDeltas(ws->delta[l - 1], ws->O[l], 0, layer->stride, layer->in);
+    }
+
+    // First Layer's Inputs Need No Deltas, Only Its Update is Left
+    // Whole Padded Rows Are Updated, the Zero Padding of the Input Keeping W's at Zero
+
+    updateLayer(net->layers[0].W, net->layers[0].stride, net->layers[0].out, ws->O[0], ws->delta[0], net->learn_rate);
+}
+
+// Function to Train Neural Network on the Sample of the Last Activation
+void trainNN(Network *net, Workspace *ws, const double *target)
+{
+    const int L = net->n_layers;
+
+    StatSamples(ws->stats, 1);
+
+    if (net->train != NULL)
+    {
+        net->train(net, ws, target);
+        return;
+    }
+
+    StatBegin(t0);
+
+    // Output Layer Deltas
+
+    outputDeltas(net->widths[L], target, ws->O[L], ws->delta[L - 1]);
+
+    StatEnd(ws->stats, PhaseDeltas, t0);
+    StatBegin(t1);
+
+    // Hidden Layer Deltas Fused with the Weight Updates, Bias Included Through the Bias Slot of the Layer Input
+
+    backwardNN(net, ws);
+
+    StatEnd(ws->stats, PhaseUpdate, t1);
+}
+
+// ***********************************
+// Batched Passes
+// ***********************************
+
+// Function to Activate Neural Network on a Batch of Samples
+void activateNNBatch(const Network *net, Workspace *ws, const double *in, int batch)
+{
+    const int in_n = net->widths[0];
+
+    StatBegin(t0);
+
+    if (net->precision != PrecisionDouble)
+    {
+        activateNNBatchFloat(net, ws, in, batch);
+        StatEnd(ws->stats, PhaseForward, t0);
+        return;
+    }
+
+    for (int b = 0; b < batch; b++)
+        memcpy(ws->OB[0] + (size_t)b * ws->ld[0], in + (size_t)b * in_n, in_n * sizeof(double));
+
+    for (int l = 0; l < net->n_layers; l++)
+    {
+        const Layer *layer = &net->layers[l];
+        const int ld_out = ws->ld[l + 1];
+        double *DB = ws->DB[l];
+        double *OB = ws->OB[l + 1];
+
+        for (int b = 0; b < batch; b++)
+            memset(DB + (size_t)b * ld_out, 0, ld_out * sizeof(double));
+
+        if (net->forward_layout == LayoutPanels && ws->pack != NULL && batch >= PackMinBatch)
+        {
+            // Repacking Costs One Pass over W, Repaid by Every Sample of the Batch Streaming Panels
+            packPanels(layer, ws->pack);
+            gemmPanels(batch, panelWidth(layer), layer->in + 1, ws->OB[l], ws->ld[l], ws->pack, PadN,
+                       (size_t)(layer->in + 1) * PadN, DB, ld_out);
+        }
+        else
+        {
+            gemmNT(net->simd, batch, layer->out, layer->stride, ws->OB[l], ws->ld[l], layer->W, layer->stride, DB, ld_out);
+        }
+
+        for (int b = 0; b < batch; b++)
+            sigmoidLayer(net->sigmoid_tier, DB + (size_t)b * ld_out, OB + (size_t)b * ld_out, layer->out);
+    }
+
+    StatEnd(ws->stats, PhaseForward, t0);
+}
+
+// Function to Get the Outputs of Sample b of the Last Batched Activation
+const double *outputNNBatch(const Network *net, const Workspace *ws, int b)
+{
+    return ws->OB[net->n_layers] + (size_t)b * ws->ld[net->n_layers];
+}
+
+// Function to Calculate Mean Total Error over a Batch of Samples
+double calcErrorBatch(const Network *net, const Workspace *ws, const double *target, int batch)
+{
+    const int L = net->n_layers;
+    const int out_n = net->widths[L];
+    double total_error = 0;
+    double temp_error;
+
+    StatBegin(t0);
+
+    for (int b = 0; b < batch; b++)
+    {
+        const double *out = ws->OB[L] + (size_t)b * ws->ld[L];
+
+        for (int i = 0; i < out_n; i++)
+        {
+            temp_error = target[(size_t)b * out_n + i] - out[i];
+            total_error += 0.5 * (temp_error * temp_error);
+        }
+    }
+
+    StatEnd(ws->stats, PhaseError, t0);
+
+    return total_error / batch;
+}
+
+// Helper Function to Back-Propagate the Deltas of the Last Batched Activation
+static void deltasBatch(const Network *net, Workspace *ws, const double *target, int batch)
+{
+    const int L = net->n_layers;
+    const int out_n = net->widths[L];
+
+    StatBegin(t0);
+
+    // Output Layer Deltas
+
+    for (int b = 0; b < batch; b++)
+    {
+        const double *out = ws->OB[L] + (size_t)b * ws->ld[L];
+        double *delta = ws->deltaB[L - 1] + (size_t)b * ws->ld[L];
+
+        for (int i = 0; i < out_n; i++)
+        {
+            double error_out = (target[(size_t)b * out_n + i] - out[i]);
+            delta[i] = (error_out * dSigmoid(out[i]));
+        }
+    }
+
+    // Back-Propagate Error Through Each Layer's Weights (Before Updating Them)
+
+    for (int l = L - 1; l > 0; l--)
+    {
+        const Layer *layer = &net->layers[l];
+        const int ld = ws->ld[l];
+        double *delta = ws->deltaB[l - 1];
+
+        for (int b = 0; b < batch; b++)
+            memset(delta + (size_t)b * ld, 0, ld * sizeof(double));
+
+        // Rows of W Already Lie Along the Inputs, so Each Row Slice of PadN Inputs is a Panel as It Stands
+        if (net->backward_layout == LayoutPanels && batch >= PanelRows)
+            gemmPanels(batch, layer->stride, layer->out, ws->deltaB[l], ws->ld[l + 1], layer->W, layer->stride, PadN, delta, ld);
+        else
+            gemmNN(batch, layer->in, layer->out, ws->deltaB[l], ws->ld[l + 1], layer->W, layer->stride, delta, ld);
+
+        // Panels Also Reach the Bias Slot and Padding, Cleared Again as No Layer Reads Them
+        for (int b = 0; b < batch; b++)
+            for (int i = 0; i < ld; i++)
+                delta[(size_t)b * ld + i] = (i < layer->in) ? delta[(size_t)b * ld + i] * dSigmoid(ws->OB[l][(size_t)b * ld + i]) : 0.0;
+    }
+
+    StatEnd(ws->stats, PhaseDeltas, t0);
+}
+
+// Function to Train Neural Network with One Averaged Update per Batch
+void trainNNBatch(Network *net, Workspace *ws, const double *target, int batch)
+{
+    const int L = net->n_layers;
+    const double rate = net->learn_rate / batch;
+
+    StatSamples(ws->stats, batch);
+
+    if (net->precision != PrecisionDouble)
+    {
+        trainNNBatchFloat(net, ws, target, batch);
+        return;
+    }
+
+    deltasBatch(net, ws, target, batch);
+
+    StatBegin(t0);
+
+    // Update Weights, Bias Included Through the Bias Slot of the Layer Input
+
+    for (int l = L - 1; l >= 0; l--)
+    {
+        Layer *layer = &net->layers[l];
+
+        gemmTN(layer->out, layer->in + 1, batch, rate, ws->deltaB[l], ws->ld[l + 1], ws->OB[l], ws->ld[l], layer->W, layer->stride);
+    }
+
+    StatEnd(ws->stats, PhaseUpdate, t0);
+}
+
+// Function to Add the Summed Weight Gradient of the Last Batched Activation to grad
+// grad Has the Layout of the Weight Arena, so the Update is a Single AXPY over It
+void gradientNNBatch(const Network *net, Workspace *ws, const double *target, int batch, double *grad)
+{
+    StatSamples(ws->stats, batch);
+
+    deltasBatch(net, ws, target, batch);
+
+    StatBegin(t0);
+
+    for (int l = net->n_layers - 1; l >= 0; l--)
+    {
+        const Layer *layer = &net->layers[l];
+        double *G = grad + (layer->W - net->weights);
+
+        gemmTN(layer->out, layer->in + 1, batch, 1.0, ws->deltaB[l], ws->ld[l + 1], ws->OB[l], ws->ld[l], G, layer->stride);
+    }
+
+    StatEnd(ws->stats, PhaseUpdate, t0);
+}
+
+// Function to Apply a Summed Gradient, W += rate * grad
+void applyGradient(Network *net, const double *grad, double rate)
+{
+    net->simd->axpy(rate, grad, net->weights, net->n_weights);
+}
@@ -0,0 +1,168 @@
+// ********************************************************************************
+// Runtime-Configurable Error Back - Propagation Neural Network
+// ********************************************************************************
+
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sigmoid.h"
+#include "simd.h"
+#include "stats.h"
+
+// Definitions - Macros
+#define CacheLine 64                                // Alignment of All Buffers in Bytes
+#define PadN ((int)(CacheLine / sizeof(double)))    // Row Strides Are Multiples of This
+#define MaxLayers 16                                // Maximum Number of Layer Widths
+
+// Scalar Type of Weights, Activations and Their Arithmetic
+typedef enum
+{
+    PrecisionDouble,    // double Throughout, Every Path Available
+    PrecisionFloat,     // float Storage and Arithmetic, Twice the SIMD Lanes, Half the Traffic
+    PrecisionMixed,     // float Storage, Dot Products and Error Sums Accumulated in double
+    Precisions
+} Precision;
+
+// Layout a Batched Double Precision Pass Reads a Layer's Weights In, Chosen per Direction
+typedef enum
+{
+    LayoutRows,         // Straight from W, One Dot Product per Sample and Neuron, or a Plain Row GEMM
+    LayoutPanels,       // Panels of PadN Neurons by Every Input, Unit-Stride Lines for a Register-Blocked GEMM
+    Layouts
+} WeightLayout;
+
+// One Fully Connected Layer, Mapping in Inputs to out Neurons
+// Row i of W Holds the in Weights of Neuron i, Its Bias at Column in, Then Zero Padding
+typedef struct
+{
+    int in;             // Inputs to Layer (Excluding Bias)
+    int out;            // Neurons in Layer
+    int stride;         // Padded Row Length of W in Weights
+    size_t offset;      // Position of Row 0 in the Weight Arena
+    double *W;          // Weights [out][stride], Points into Network Arena
+    float *Wf;          // Same Layout in the float Arena, Only One of W and Wf is Set
+} Layer;
+
+// Network Topology and Weights, Shared by All Workspaces Using It
+// Passes Touch Nothing but the Network and Workspace They Are Given, Both Cache Line Aligned
+// and Padded, so Separate Pairs Train or Infer on Separate Threads with No Sharing at All
+typedef struct Network Network;
+typedef struct Workspace Workspace;
+
+struct Network
+{
+    int n_layers;               // Number of Weight Layers
+    int widths[MaxLayers];      // Layer Widths, Input Layer First [n_layers + 1]
+    Layer layers[MaxLayers - 1];
+    double *weights;            // Single Aligned Arena Holding All Layer Weights
+    float *weights_f;           // Its float Counterpart, Used Instead When precision is Not Double
+    size_t n_weights;           // Weights in Arena, Including Padding
+    Precision precision;
+    double learn_rate;
+    const SimdKernels *simd;    // Dot Product and GEMV Kernels Chosen for This CPU
+    SigmoidTier sigmoid_tier;   // Accuracy of the Activation, SigmoidExact by Default
+
+    // Batched Passes Big Enough to Repay It Read W as Panels by Default
+    // Forward Packs W Transposed into Panels Once per Call, Backward Takes Each Row Slice of W as One
+    WeightLayout forward_layout;
+    WeightLayout backward_layout;
+
+    // Passes Specialized for This Topology at Construction, NULL Selects the Generic Path
+    void (*activate)(const Network *net, Workspace *ws);
+    void (*train)(Network *net, Workspace *ws, const double *target);
+};
+
+// Activations and Deltas of One Forward/Backward Pass
+// Every Output Vector is Padded to the Stride of the Layer Reading It, with a 1 in
+// the Bias Slot, so Each Neuron is a Single Dot Product over the Full Padded Row
+struct Workspace
+{
+    int n_layers;
+    int batch_cap;                  // Maximum Samples per Batched Call
+    double *O[MaxLayers];           // Layer Outputs, O[0] is the Padded Input [n_layers + 1]
+    double *D[MaxLayers];           // Pre-Activation Values [n_layers], D[l] Feeds O[l + 1]
+    double *delta[MaxLayers];       // Back-Propagated Deltas [n_layers], Same Shape as D
+    double *OB[MaxLayers];          // Batched Outputs [batch_cap][stride] per Layer
+    double *DB[MaxLayers];          // Batched Pre-Activation Values
+    double *deltaB[MaxLayers];      // Batched Deltas
+    int ld[MaxLayers];              // Padded Length of O[l] and Row Stride of OB[l]
+    double *pack;                   // A Layer's Forward Panels, Repacked per Batched Call, Double Only
+    double *arena;                  // Single Aligned Allocation Backing All of the Above
+
+    // float Counterparts of the Above, Same Layout, Allocated for float and Mixed Networks
+    // Their Passes Still Widen the Output Layer into O and OB, so Error and Output Are double
+    float *Of[MaxLayers], *Df[MaxLayers], *deltaf[MaxLayers];
+    float *OBf[MaxLayers], *DBf[MaxLayers], *deltaBf[MaxLayers];
+    float *arena_f;
+
+#ifdef EBP_STATS
+    PhaseStats *stats;              // Phase Timers of the Passes Using This Workspace, on Its Own Cache Line
+#endif
+};
+
+// Helper Functions
+void *alignedAlloc(size_t bytes);
+double initWeight(uint64_t seed, size_t index);
+int paddedStride(int n);
+int parseTopology(const char *spec, int *widths, int max_widths);
+const char *precisionName(Precision precision);
+int parsePrecision(const char *name);
+const char *layoutName(WeightLayout layout);
+int parseLayout(const char *name);
+int parseLayouts(const char *spec, WeightLayout *forward, WeightLayout *backward);
+void shuffleSamples(double *in, int in_n, double *target, int out_n, int n_samples, uint64_t seed, uint64_t round);
+
+// Construction and Destruction
+Network *createNN(const int *widths, int n_widths, double learn_rate, Precision precision);
+void freeNN(Network *net);
+Workspace *createWorkspace(const Network *net, int batch_cap);
+void freeWorkspace(Workspace *ws);
+void initializeWeights(Network *net, uint64_t seed);
+double *createGradient(const Network *net);
+void freeGradient(double *grad);
+
+// Caller-Owned Construction, Nothing is Allocated or Kept Outside the Given Memory
+// The Caller Supplies the Struct and a CacheLine-Aligned Buffer of the Reported Size,
+// Releases Both Itself, and Never Passes Them to freeNN() or freeWorkspace()
+size_t networkBytes(const int *widths, int n_widths, Precision precision);
+int initNN(Network *net, const int *widths, int n_widths, double learn_rate, Precision precision, void *buf);
+size_t workspaceBytes(const Network *net, int batch_cap);
+int initWorkspace(Workspace *ws, const Network *net, int batch_cap, void *buf);
+
+// Single Sample Passes, Inputs and Targets Are double for Every Precision
+void activateNN(const Network *net, Workspace *ws, const double *in);
+double calcError(const Network *net, const Workspace *ws, const double *target);
+void trainNN(Network *net, Workspace *ws, const double *target);
+const double *outputNN(const Network *net, const Workspace *ws);
+
+// Batched Passes, Inputs and Targets Are Contiguous [batch][width] Rows
+void activateNNBatch(const Network *net, Workspace *ws, const double *in, int batch);
+double calcErrorBatch(const Network *net, const Workspace *ws, const double *target, int batch);
+void trainNNBatch(Network *net, Workspace *ws, const double *target, int batch);
+const double *outputNNBatch(const Network *net, const Workspace *ws, int b);
+
+// Gradient Passes, Double Precision Networks Only
+void gradientNNBatch(const Network *net, Workspace *ws, const double *target, int batch, double *grad);
+void applyGradient(Network *net, const double *grad, double rate);
+
+// Team Passes, Called by Every Thread of an Enclosing OpenMP Parallel Region
+// Outside a Parallel Region (or Without OpenMP) They Run Like the Serial Passes,
+// and float or Mixed Networks Always Do
+void activateNNTeam(const Network *net, Workspace *ws, const double *in);
+void trainNNTeam(Network *net, Workspace *ws, const double *target);
+
+// Function to Check Whether the Team Passes Split Any Layer of net, Otherwise Every Thread but One Idles
+int teamSplitsNN(const Network *net);
+
+// Data-Parallel Step, Called by Every Thread with Its Own Workspace and grads[thread], Double Only
+// Each Thread Owns a Contiguous Shard of the n_samples Rows, Returns Mean Error Before the Update
+double trainNNData(Network *net, Workspace *ws, double *const *grads, const double *in, const double *target, int n_samples);
+
+// Asynchronous Alternative, Lock-Free Per-Sample Updates over the Same Shards, No Barriers
+// Returns the Calling Thread's Error Sum over Its Shard
+double trainNNHogwild(Network *net, Workspace *ws, const double *in, const double *target, int n_samples);
+
+#endif
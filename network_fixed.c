@@ -0,0 +1,89 @@
+// ********************************************************************************
+// Fixed-Size Kernels for Small Single Hidden Layer Networks
+// ********************************************************************************
+
+// Include Libraries
+#include <stddef.h>
+
+#include "network.h"
+#include "kernels.h"
+
+// *******************************************************************
+#pragma GCC optimize("O3","unroll-loops","omit-frame-pointer","inline", "unsafe-math-optimizations")
+//************************************************************
+
+// Definitions - Macros
+#define FixedPad(n) ((((n) + 1 + PadN - 1) / PadN) * PadN)    // Compile-Time paddedStride()
+
+// Specialized Shapes as Input, Hidden and Output Widths
+// Add a Line Here to Get a Fully Unrolled Path for Another Deployed Model
+#define FixedShapes(X)  \
+    X(12, 100, 10)      \
+    X(8, 16, 4)         \
+    X(16, 64, 10)       \
+    X(32, 128, 10)
+
+// Every Specialization is Cloned for the Baseline, AVX2+FMA (x86-64-v3) and AVX-512
+// (x86-64-v4) Levels, the Loader Resolving Each Clone Once from CPUID Feature Bits
+#define FixedTargets __attribute__((target_clones("default", "arch=x86-64-v3", "arch=x86-64-v4")))
+
+// Instantiate Forward and Training Passes for One Shape
+// Every Size Passed to the Inline Kernels is a Constant Expression
+#define DefineFixedNN(IN, HID, OUT)                                                                                 \
+FixedTargets                                                                                                        \
+static void activateNN_##IN##_##HID##_##OUT(const Network *net, Workspace *ws)                                      \
+{                                                                                                                   \
+    forwardLayer(net->layers[0].W, FixedPad(IN), HID, net->sigmoid_tier, ws->O[0], ws->D[0], ws->O[1]);             \
+    forwardLayer(net->layers[1].W, FixedPad(HID), OUT, net->sigmoid_tier, ws->O[1], ws->D[1], ws->O[2]);            \
+}                                                                                                                   \
+                                                                                                                    \
+FixedTargets                                                                                                        \
+static void trainNN_##IN##_##HID##_##OUT(Network *net, Workspace *ws, const double *target)                         \
+{                                                                                                                   \
+    StatBegin(t0);                                                                                                  \
+    outputDeltas(OUT, target, ws->O[2], ws->delta[1]);                                                              \
+    StatEnd(ws->stats, PhaseDeltas, t0);                                                                            \
+    StatBegin(t1);                                                                                                  \
+    backpropLayer(net->layers[1].W, FixedPad(HID), OUT, 0, FixedPad(HID), ws->delta[1], ws->O[1], ws->delta[0],    \
+                  net->learn_rate);                                                                                 \
+    finishDeltas(ws->delta[0], ws->O[1], 0, FixedPad(HID), HID);                                                    \
+    updateLayer(net->layers[0].W, FixedPad(IN), HID, ws->O[0], ws->delta[0], net->learn_rate);                      \
+    StatEnd(ws->stats, PhaseUpdate, t1);                                                                            \
+}
+
+FixedShapes(DefineFixedNN)
+
+// Table of All Specializations
+typedef struct
+{
+    int widths[3];
+    void (*activate)(const Network *net, Workspace *ws);
+    void (*train)(Network *net, Workspace *ws, const double *target);
+} FixedEntry;
+
+#define FixedTableEntry(IN, HID, OUT)                                                                               \
+    { { IN, HID, OUT }, activateNN_##IN##_##HID##_##OUT, trainNN_##IN##_##HID##_##OUT },
+
+static const FixedEntry fixed_table[] = { FixedShapes(FixedTableEntry) };
+
+// Function to Bind Fixed-Size Kernels if the Topology Has a Specialization
+// Returns 1 if Bound, 0 if the Network Keeps the Generic Path
+int bindFixedKernels(Network *net)
+{
+    if (net->n_layers != 2)
+        return 0;
+
+    for (size_t k = 0; k < sizeof(fixed_table) / sizeof(fixed_table[0]); k++)
+    {
+        const FixedEntry *e = &fixed_table[k];
+
+        if (e->widths[0] == net->widths[0] && e->widths[1] == net->widths[1] && e->widths[2] == net->widths[2])
+        {
+            net->activate = e->activate;
+            net->train = e->train;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,328 @@
+// ********************************************************************************
+// Single and Mixed Precision Passes, float Weights and Activations
+// ********************************************************************************
+
+// Include Libraries
+#include <stddef.h>
+
+#include "network.h"
+#include "kernels.h"
+
+// *******************************************************************
+#pragma GCC optimize("O3","unroll-loops","omit-frame-pointer","inline", "unsafe-math-optimizations")
+//************************************************************
+
+// Definitions - Macros
+#define RowAlign (PadN * (int)sizeof(float))    // float Rows Share the double Stride, so Half a Line
+
+// Cloned for the Baseline, AVX2+FMA and AVX-512 Levels, Each Twice as Wide in float
+#define FloatTargets __attribute__((target_clones("default", "arch=x86-64-v3", "arch=x86-64-v4")))
+
+// ***********************************
+// Layer Kernels
+// ***********************************
+
+// Every Kernel Takes mixed as a Constant, Picking float or double Accumulators,
+// so Each Caller Below Inlines Into a Pure Single or Mixed Precision Loop
+
+// Helper Function to Forward One Layer, One Padded Dot Product per Neuron
+KernelInline void forwardLayerF(const float *restrict W, int stride, int out, SigmoidTier tier,
+                                const float *restrict x, float *restrict D, float *restrict O, const int mixed)
+{
+    x = __builtin_assume_aligned(x, RowAlign);
+
+    for (int i = 0; i < out; i++)
+    {
+        const float *w = __builtin_assume_aligned(W + (size_t)i * stride, RowAlign);
+
+        if (mixed)
+        {
+            double sum = 0.0;
+            for (int j = 0; j < stride; j++)
+                sum += (double)w[j] * x[j];
+            D[i] = (float)sum;
+        }
+        else
+        {
+            float sum = 0.0f;
+            for (int j = 0; j < stride; j++)
+                sum += w[j] * x[j];
+            D[i] = sum;
+        }
+    }
+
+    sigmoidLayerF(tier, D, O, out);
+}
+
+// Helper Function to Calculate Output Layer Deltas
+KernelInline void outputDeltasF(int out, const double *restrict target,
+                                const float *restrict O, float *restrict delta, const int mixed)
+{
+    for (int i = 0; i < out; i++)
+    {
+        if (mixed)
+            delta[i] = (float)((target[i] - O[i]) * ((double)O[i] * (1.0 - O[i])));
+        else
+            delta[i] = ((float)target[i] - O[i]) * (O[i] * (1.0f - O[i]));
+    }
+}
+
+// Helper Function to Back-Propagate Deltas of a Layer to Its Inputs
+// Walks Whole Rows of W, Summing into acc, a double Scratch of at Least in Values
+KernelInline void hiddenDeltasF(const float *restrict W, int stride, int out, int in,
+                                const float *restrict delta_next, const float *restrict O,
+                                float *restrict delta, double *restrict acc, const int mixed)
+{
+    float *accf = (float *)acc;
+
+    for (int j = 0; j < in; j++)
+    {
+        if (mixed)
+            acc[j] = 0.0;
+        else
+            accf[j] = 0.0f;
+    }
+
+    for (int i = 0; i < out; i++)
+    {
+        const float *w = __builtin_assume_aligned(W + (size_t)i * stride, RowAlign);
+        const float d = delta_next[i];
+
+        for (int j = 0; j < in; j++)
+        {
+            if (mixed)
+                acc[j] += (double)d * w[j];
+            else
+                accf[j] += d * w[j];
+        }
+    }
+
+    for (int j = 0; j < in; j++)
+    {
+        if (mixed)
+            delta[j] = (float)(acc[j] * ((double)O[j] * (1.0 - O[j])));
+        else
+            delta[j] = accf[j] * (O[j] * (1.0f - O[j]));
+    }
+}
+
+// Helper Function to Update Layer Weights, Bias Included Through the Bias Slot of x
+KernelInline void updateLayerF(float *restrict W, int stride, int out,
+                               const float *restrict x, const float *restrict delta, double rate)
+{
+    x = __builtin_assume_aligned(x, RowAlign);
+
+    for (int i = 0; i < out; i++)
+    {
+        float *w = __builtin_assume_aligned(W + (size_t)i * stride, RowAlign);
+        const float a = (float)(rate * delta[i]);
+
+        for (int j = 0; j < stride; j++)
+            w[j] += a * x[j];
+    }
+}
+
+// Helper Function to Convert n Values Between Precisions
+KernelInline void narrow(const double *restrict src, float *restrict dst, int n)
+{
+    for (int i = 0; i < n; i++)
+        dst[i] = (float)src[i];
+}
+
+KernelInline void widen(const float *restrict src, double *restrict dst, int n)
+{
+    for (int i = 0; i < n; i++)
+        dst[i] = src[i];
+}
+
+// ***********************************
+// Single Sample Passes
+// ***********************************
+
+// Helper Function to Activate the Network on the Input activateNN Copied into O[0]
+KernelInline void activateReal(const Network *net, Workspace *ws, const int mixed)
+{
+    const int L = net->n_layers;
+
+    narrow(ws->O[0], ws->Of[0], net->widths[0]);
+
+    for (int l = 0; l < L; l++)
+    {
+        const Layer *layer = &net->layers[l];
+
+        forwardLayerF(layer->Wf, layer->stride, layer->out, net->sigmoid_tier, ws->Of[l], ws->Df[l], ws->Of[l + 1], mixed);
+    }
+
+    widen(ws->Of[L], ws->O[L], net->widths[L]);     // double Output for outputNN() and calcError()
+}
+
+// Helper Function to Train the Network on the Sample of the Last Activation
+KernelInline void trainReal(Network *net, Workspace *ws, const double *target, const int mixed)
+{
+    const int L = net->n_layers;
+
+    StatBegin(t0);
+
+    outputDeltasF(net->widths[L], target, ws->Of[L], ws->deltaf[L - 1], mixed);
+
+    for (int l = L - 1; l > 0; l--)     // Scratch is the Unused double Delta of the Same Layer
+    {
+        const Layer *layer = &net->layers[l];
+
+        hiddenDeltasF(layer->Wf, layer->stride, layer->out, layer->in, ws->deltaf[l], ws->Of[l], ws->deltaf[l - 1], ws->delta[l - 1], mixed);
+    }
+
+    StatEnd(ws->stats, PhaseDeltas, t0);
+    StatBegin(t1);
+
+    for (int l = L - 1; l >= 0; l--)
+    {
+        Layer *layer = &net->layers[l];
+
+        updateLayerF(layer->Wf, layer->stride, layer->out, ws->Of[l], ws->deltaf[l], net->learn_rate);
+    }
+
+    StatEnd(ws->stats, PhaseUpdate, t1);
+}
+
+FloatTargets static void activateNNFloat(const Network *net, Workspace *ws)
+{
+    activateReal(net, ws, 0);
+}
+
+FloatTargets static void activateNNMixed(const Network *net, Workspace *ws)
+{
+    activateReal(net, ws, 1);
+}
+
+FloatTargets static void trainNNFloat(Network *net, Workspace *ws, const double *target)
+{
+    trainReal(net, ws, target, 0);
+}
+
+FloatTargets static void trainNNMixed(Network *net, Workspace *ws, const double *target)
+{
+    trainReal(net, ws, target, 1);
+}
+
+// ***********************************
+// Batched Passes
+// ***********************************
+
+// Helper Function to Activate the Network on a Batch, Sample by Sample
+KernelInline void activateBatchReal(const Network *net, Workspace *ws, const double *in, int batch, const int mixed)
+{
+    const int L = net->n_layers;
+
+    for (int b = 0; b < batch; b++)
+    {
+        narrow(in + (size_t)b * net->widths[0], ws->OBf[0] + (size_t)b * ws->ld[0], net->widths[0]);
+
+        for (int l = 0; l < L; l++)
+        {
+            const Layer *layer = &net->layers[l];
+
+            forwardLayerF(layer->Wf, layer->stride, layer->out, net->sigmoid_tier, ws->OBf[l] + (size_t)b * ws->ld[l],
+                          ws->DBf[l] + (size_t)b * ws->ld[l + 1], ws->OBf[l + 1] + (size_t)b * ws->ld[l + 1], mixed);
+        }
+
+        widen(ws->OBf[L] + (size_t)b * ws->ld[L], ws->OB[L] + (size_t)b * ws->ld[L], net->widths[L]);
+    }
+}
+
+// Helper Function to Train with One Averaged Update per Batch
+// All Deltas Are Taken Before Any Update, Then Each Row of W Takes the Whole Batch While in Cache
+KernelInline void trainBatchReal(Network *net, Workspace *ws, const double *target, int batch, const int mixed)
+{
+    const int L = net->n_layers;
+    const double rate = net->learn_rate / batch;
+
+    StatBegin(t0);
+
+    for (int b = 0; b < batch; b++)
+    {
+        outputDeltasF(net->widths[L], target + (size_t)b * net->widths[L], ws->OBf[L] + (size_t)b * ws->ld[L],
+                      ws->deltaBf[L - 1] + (size_t)b * ws->ld[L], mixed);
+
+        for (int l = L - 1; l > 0; l--)
+        {
+            const Layer *layer = &net->layers[l];
+
+            hiddenDeltasF(layer->Wf, layer->stride, layer->out, layer->in, ws->deltaBf[l] + (size_t)b * ws->ld[l + 1],
+                          ws->OBf[l] + (size_t)b * ws->ld[l], ws->deltaBf[l - 1] + (size_t)b * ws->ld[l], ws->delta[l - 1], mixed);
+        }
+    }
+
+    StatEnd(ws->stats, PhaseDeltas, t0);
+    StatBegin(t1);
+
+    for (int l = L - 1; l >= 0; l--)
+    {
+        Layer *layer = &net->layers[l];
+
+        for (int i = 0; i < layer->out; i++)
+        {
+            float *w = __builtin_assume_aligned(layer->Wf + (size_t)i * layer->stride, RowAlign);
+
+            for (int b = 0; b < batch; b++)
+            {
+                const float *x = __builtin_assume_aligned(ws->OBf[l] + (size_t)b * ws->ld[l], RowAlign);
+                const float a = (float)(rate * ws->deltaBf[l][(size_t)b * ws->ld[l + 1] + i]);
+
+                for (int j = 0; j < layer->stride; j++)
+                    w[j] += a * x[j];
+            }
+        }
+    }
+
+    StatEnd(ws->stats, PhaseUpdate, t1);
+}
+
+FloatTargets static void activateBatchFloat(const Network *net, Workspace *ws, const double *in, int batch)
+{
+    activateBatchReal(net, ws, in, batch, 0);
+}
+
+FloatTargets static void activateBatchMixed(const Network *net, Workspace *ws, const double *in, int batch)
+{
+    activateBatchReal(net, ws, in, batch, 1);
+}
+
+FloatTargets static void trainBatchFloat(Network *net, Workspace *ws, const double *target, int batch)
+{
+    trainBatchReal(net, ws, target, batch, 0);
+}
+
+FloatTargets static void trainBatchMixed(Network *net, Workspace *ws, const double *target, int batch)
+{
+    trainBatchReal(net, ws, target, batch, 1);
+}
+
+// ***********************************
+// Dispatch
+// ***********************************
+
+// Function to Bind the Single Sample Passes of a float or Mixed Network
+void bindFloatKernels(Network *net)
+{
+    net->activate = (net->precision == PrecisionMixed) ? activateNNMixed : activateNNFloat;
+    net->train = (net->precision == PrecisionMixed) ? trainNNMixed : trainNNFloat;
+}
+
+// Function to Activate a float or Mixed Network on a Batch of Samples
+void activateNNBatchFloat(const Network *net, Workspace *ws, const double *in, int batch)
+{
+    if (net->precision == PrecisionMixed)
+        activateBatchMixed(net, ws, in, batch);
+    else
+        activateBatchFloat(net, ws, in, batch);
+}
+
+// Function to Train a float or Mixed Network with One Averaged Update per Batch
+void trainNNBatchFloat(Network *net, Workspace *ws, const double *target, int batch)
+{
+    if (net->precision == PrecisionMixed)
+        trainBatchMixed(net, ws, target, batch);
+    else
+        trainBatchFloat(net, ws, target, batch);
+}
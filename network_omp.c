@@ -0,0 +1,311 @@
+// ********************************************************************************
+// Thread-Parallel Single Sample Passes for a Persistent OpenMP Thread Team
+// ********************************************************************************
+
+// Include Libraries
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "network.h"
+#include "kernels.h"
+
+// *******************************************************************
+#pragma GCC optimize("O3","unroll-loops","omit-frame-pointer","inline", "unsafe-math-optimizations")
+//************************************************************
+
+// Definitions - Macros
+#define TeamMinWork 8192    // Multiply-Adds a Thread Must Get for a Barrier to Pay Off
+
+// A Split Pass Shares One Workspace, so Only the Team's Lead Times It, Barrier Waits Included
+#if defined(EBP_STATS) && defined(_OPENMP)
+#define TeamLead (omp_get_thread_num() == 0)
+#else
+#define TeamLead 1
+#endif
+
+// ***********************************
+// Work Partitioning
+// ***********************************
+
+// Helper Function to Split n Items Costing work Each Across the Team
+// Chunks Are Whole Cache Lines of Outputs, so No Two Threads Write the Same Line,
+// and Only as Many Threads Join as Have TeamMinWork to Do, the Rest Get [0, 0)
+static void teamSpan(size_t n, size_t work, size_t *begin, size_t *end)
+{
+#ifdef _OPENMP
+    const int nth = omp_get_num_threads();
+    const int tid = omp_get_thread_num();
+#else
+    const int nth = 1;
+    const int tid = 0;
+#endif
+    const size_t lines = (n + PadN - 1) / PadN;
+    size_t active = (n * work) / TeamMinWork;
+
+    if (active > (size_t)nth)
+        active = (size_t)nth;
+    if (active > lines)
+        active = lines;
+    if (active < 1)
+        active = 1;
+
+    if ((size_t)tid >= active)
+    {
+        *begin = *end = 0;
+        return;
+    }
+
+    const size_t t = (size_t)tid;
+    const size_t per = lines / active;
+    const size_t extra = lines % active;
+    const size_t first = t * per + (t < extra ? t : extra);
+    const size_t last = first + per + (t < extra ? 1 : 0);
+
+    *begin = first * PadN;
+    *end = (last * PadN < n) ? last * PadN : n;
+}
+
+// Helper Function to Split a Layer's n Neurons Costing work Each Across the Team
+static void teamRange(int n, int work, int *begin, int *end)
+{
+    size_t b, e;
+
+    teamSpan((size_t)n, (size_t)work, &b, &e);
+
+    *begin = (int)b;
+    *end = (int)e;
+}
+
+// Function to Check Whether Any Layer is Big Enough for the Team Passes to Split
+// Only Double Precision Has Split Passes, float and Mixed Run on One Thread
+int teamSplitsNN(const Network *net)
+{
+    if (net->precision != PrecisionDouble)
+        return 0;
+
+    for (int l = 0; l < net->n_layers; l++)
+        if ((long)net->layers[l].out * net->layers[l].stride >= 2 * TeamMinWork)
+            return 1;
+
+    return 0;
+}
+
+// Helper Function to Sweep Columns [b, e) of a Layer, Back-Propagating Its Deltas and Updating It
+// Cloned for the Baseline, AVX2+FMA and AVX-512 Levels Like the Serial Sweep
+__attribute__((target_clones("default", "arch=x86-64-v3", "arch=x86-64-v4")))
+static void backpropTeam(const Network *net, Layer *layer, int b, int e, const double *delta_next,
+                         const double *O, double *delta)
+{
+    backpropLayer(layer->W, layer->stride, layer->out, b, e, delta_next, O, delta, net->learn_rate);
+    finishDeltas(delta, O, b, e, layer->in);
+}
+
+// ***********************************
+// Team Passes
+// ***********************************
+
+// Function to Activate Neural Network with the Calling Thread Team
+// Every Thread of the Team Must Call It, Small Networks Run on One Thread
+void activateNNTeam(const Network *net, Workspace *ws, const double *in)
+{
+    if (!teamSplitsNN(net))
+    {
+        #pragma omp single
+        activateNN(net, ws, in);
+
+        return;
+    }
+
+    StatBegin(t0);
+
+    #pragma omp single
+    memcpy(ws->O[0], in, net->widths[0] * sizeof(double));
+
+    for (int l = 0; l < net->n_layers; l++)    // Layers in Order, a Barrier Between Each
+    {
+        const Layer *layer = &net->layers[l];
+        int b, e;
+
+        teamRange(layer->out, layer->stride, &b, &e);
+
+        if (b < e)                              // This Thread's Neurons
+        {
+            net->simd->gemv(layer->W + (size_t)b * layer->stride, layer->stride, e - b, ws->O[l], layer->stride, ws->D[l] + b);
+            sigmoidLayer(net->sigmoid_tier, ws->D[l] + b, ws->O[l + 1] + b, e - b);
+        }
+
+        #pragma omp barrier
+    }
+
+    if (TeamLead)
+        StatEnd(ws->stats, PhaseForward, t0);
+}
+
+// Function to Train Neural Network with the Calling Thread Team
+// Every Thread of the Team Must Call It, Small Networks Run on One Thread
+void trainNNTeam(Network *net, Workspace *ws, const double *target)
+{
+    const int L = net->n_layers;
+
+    if (!teamSplitsNN(net))
+    {
+        #pragma omp single
+        trainNN(net, ws, target);
+
+        return;
+    }
+
+    StatBegin(t0);
+
+    // Output Layer Deltas
+
+    #pragma omp single
+    outputDeltas(net->widths[L], target, ws->O[L], ws->delta[L - 1]);
+
+    if (TeamLead)
+        StatEnd(ws->stats, PhaseDeltas, t0);
+
+    StatBegin(t1);
+
+    // Hidden Layer Deltas Fused with Their Layer's Update, Each Thread Sweeping Its Own Columns
+    // of the Weights, Then Finishing the Deltas of Those Columns Before the Layer Below Reads Them
+
+    for (int l = L - 1; l > 0; l--)
+    {
+        Layer *layer = &net->layers[l];
+        int b, e;
+
+        teamRange(layer->stride, layer->out, &b, &e);
+
+        if (b < e)
+            backpropTeam(net, layer, b, e, ws->delta[l], ws->O[l], ws->delta[l - 1]);
+
+        #pragma omp barrier
+    }
+
+    // First Layer's Update, Each Thread Owning Whole Rows
+
+    Layer *first = &net->layers[0];
+    int b, e;
+
+    teamRange(first->out, first->stride, &b, &e);
+
+    for (int i = b; i < e; i++)
+        net->simd->axpy(ws->delta[0][i] * net->learn_rate, ws->O[0], first->W + (size_t)i * first->stride, first->stride);
+
+    #pragma omp barrier
+
+    if (TeamLead)
+    {
+        StatEnd(ws->stats, PhaseUpdate, t1);
+        StatSamples(ws->stats, 1);
+    }
+}
+
+// ***********************************
+// Data-Parallel Training
+// ***********************************
+
+// Function to Run One Synchronous Data-Parallel Step with the Calling Thread Team
+// Each Thread Sums the Gradient of Its Shard into grads[thread] in Mini-Batches of Its
+// Workspace's batch_cap, the Team Adds Them Pairwise Up a Binary Tree into grads[0],
+// Then Every Thread Applies Its Own Cache Lines of the Averaged Update
+double trainNNData(Network *net, Workspace *ws, double *const *grads, const double *in, const double *target, int n_samples)
+{
+#ifdef _OPENMP
+    const int nth = omp_get_num_threads();
+    const int tid = omp_get_thread_num();
+#else
+    const int nth = 1;
+    const int tid = 0;
+#endif
+    const int in_n = net->widths[0];
+    const int out_n = net->widths[net->n_layers];
+    const size_t n = net->n_weights + PadN;
+    double *grad = grads[tid];
+    size_t b, e;
+
+    memset(grad, 0, n * sizeof(double));
+
+    // Forward and Backward Passes over This Thread's Shard, Against the Shared Weights
+
+    const int first = (int)((long)n_samples * tid / nth);
+    const int last = (int)((long)n_samples * (tid + 1) / nth);
+
+    for (int s = first; s < last; s += ws->batch_cap)
+    {
+        const int m = (last - s < ws->batch_cap) ? last - s : ws->batch_cap;
+
+        activateNNBatch(net, ws, in + (size_t)s * in_n, m);
+        grad[net->n_weights] += calcErrorBatch(net, ws, target + (size_t)s * out_n, m) * m;
+        gradientNNBatch(net, ws, target + (size_t)s * out_n, m, grad);
+    }
+
+    // Tree Reduction, Each Sum Accumulating into the Buffer Its Own Thread Just Wrote
+
+    for (int span = 1; span < nth; span *= 2)
+    {
+        #pragma omp barrier
+
+        if (tid % (2 * span) == 0 && tid + span < nth)
+        {
+            StatBegin(t0);
+            net->simd->axpy(1.0, grads[tid + span], grad, n);
+            StatEnd(ws->stats, PhaseUpdate, t0);
+        }
+    }
+
+    #pragma omp barrier
+
+    const double error = grads[0][net->n_weights] / n_samples;
+
+    // Averaged Update, Split by Whole Cache Lines of the Weight Arena
+
+    teamSpan(net->n_weights, 1, &b, &e);
+
+    if (b < e)
+    {
+        StatBegin(t0);
+        net->simd->axpy(net->learn_rate / n_samples, grads[0] + b, net->weights + b, e - b);
+        StatEnd(ws->stats, PhaseUpdate, t0);
+    }
+
+    #pragma omp barrier
+
+    return error;
+}
+
+// ***********************************
+// Asynchronous Training
+// ***********************************
+
+// Function to Run One Lock-Free Hogwild Pass over the Calling Thread's Shard
+// Threads Train Sample by Sample with No Locks or Barriers, Their Plain Racy Updates
+// Landing on Rows Other Threads May Be Reading at the Same Time. Returns the Thread's
+// Error Sum, Each Sample's Error Taken Just Before Its Own Update
+double trainNNHogwild(Network *net, Workspace *ws, const double *in, const double *target, int n_samples)
+{
+#ifdef _OPENMP
+    const int nth = omp_get_num_threads();
+    const int tid = omp_get_thread_num();
+#else
+    const int nth = 1;
+    const int tid = 0;
+#endif
+    const int in_n = net->widths[0];
+    const int out_n = net->widths[net->n_layers];
+    const int first = (int)((long)n_samples * tid / nth);
+    const int last = (int)((long)n_samples * (tid + 1) / nth);
+    double error = 0;
+
+    for (int s = first; s < last; s++)
+    {
+        activateNN(net, ws, in + (size_t)s * in_n);
+        error += calcError(net, ws, target + (size_t)s * out_n);
+        trainNN(net, ws, target + (size_t)s * out_n);
+    }
+
+    return error;
+}
@@ -0,0 +1,197 @@
+// ********************************************************************************
+// Double-Buffered Dataset Prefetch on a Producer Thread
+// ********************************************************************************
+
+#define _POSIX_C_SOURCE 200809L
+
+// Include Libraries
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "prefetch.h"
+#include "network.h"
+
+// ***********************************
+// Helper Functions
+// ***********************************
+
+// Helper Function to Get Monotonic Time in Seconds
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+// Helper Function Run by the Producer Thread
+// Each Chunk is Read Before Waiting for a Free Slot, so Parsing or Page Faults Overlap
+// the Chunk Training, Then Copied and Shuffled into the Slot, All Off the Training Thread
+static void *produce(void *arg)
+{
+    Prefetcher *pf = arg;
+    Dataset *ds = pf->ds;
+    int next = 0;
+
+    for (;; pf->epoch++)
+    {
+        uint64_t round = pf->epoch << 32;   // Shuffle Round of the Epoch's First Chunk
+        size_t rows;
+
+        rewindDataset(ds);
+
+        do
+        {
+            const double *in, *target;
+            PrefetchSlot *slot = &pf->slots[next];
+
+            rows = readChunk(ds, &in, &target);
+
+            pthread_mutex_lock(&pf->lock);
+            while (slot->full && !pf->stop)
+                pthread_cond_wait(&pf->cond, &pf->lock);
+            const int stop = pf->stop;
+            pthread_mutex_unlock(&pf->lock);
+
+            if (stop)
+                return NULL;
+
+            memcpy(slot->in, in, rows * ds->in_n * sizeof(double));
+            memcpy(slot->target, target, rows * ds->out_n * sizeof(double));
+
+            if (pf->shuffle && rows > 1)
+                shuffleSamples(slot->in, ds->in_n, slot->target, ds->out_n, (int)rows, pf->seed, round++);
+
+            pthread_mutex_lock(&pf->lock);
+            slot->rows = rows;
+            slot->full = 1;
+            if (rows == 0)
+                pf->error = ds->error;
+            pthread_cond_broadcast(&pf->cond);
+            pthread_mutex_unlock(&pf->lock);
+
+            next = (next + 1) % PrefetchSlots;
+        } while (rows > 0);
+
+        if (ds->error)
+            return NULL;
+    }
+}
+
+// ***********************************
+// Prefetch Interface
+// ***********************************
+
+// Function to Create a Prefetcher and Start Its Producer Thread on the First Epoch
+// Slots Are Allocated Once Here, Training Only Ever Swaps Between Them
+Prefetcher *createPrefetcher(Dataset *ds, int shuffle, uint64_t seed, uint64_t first_epoch)
+{
+    Prefetcher *pf = calloc(1, sizeof(Prefetcher));
+    if (pf == NULL)
+        return NULL;
+
+    pf->ds = ds;
+    pf->shuffle = shuffle;
+    pf->seed = seed;
+    pf->epoch = first_epoch;
+    pf->held = -1;
+
+    int failed = 0;
+
+    for (int k = 0; k < PrefetchSlots; k++)
+    {
+        pf->slots[k].in = alignedAlloc(ds->chunk * ds->in_n * sizeof(double));
+        pf->slots[k].target = alignedAlloc(ds->chunk * ds->out_n * sizeof(double));
+        failed |= (pf->slots[k].in == NULL || pf->slots[k].target == NULL);
+    }
+
+    pthread_mutex_init(&pf->lock, NULL);
+    pthread_cond_init(&pf->cond, NULL);
+
+    if (failed || pthread_create(&pf->thread, NULL, produce, pf) != 0)
+    {
+        for (int k = 0; k < PrefetchSlots; k++)
+        {
+            free(pf->slots[k].in);
+            free(pf->slots[k].target);
+        }
+
+        pthread_cond_destroy(&pf->cond);
+        pthread_mutex_destroy(&pf->lock);
+        free(pf);
+        return NULL;
+    }
+
+    return pf;
+}
+
+// Function to Stop the Producer and Release the Prefetcher, the Dataset is Left Open
+void freePrefetcher(Prefetcher *pf)
+{
+    if (pf == NULL)
+        return;
+
+    pthread_mutex_lock(&pf->lock);
+    pf->stop = 1;
+    pthread_cond_broadcast(&pf->cond);
+    pthread_mutex_unlock(&pf->lock);
+
+    pthread_join(pf->thread, NULL);
+
+    for (int k = 0; k < PrefetchSlots; k++)
+    {
+        free(pf->slots[k].in);
+        free(pf->slots[k].target);
+    }
+
+    pthread_cond_destroy(&pf->cond);
+    pthread_mutex_destroy(&pf->lock);
+    free(pf);
+}
+
+// Function to Get the Next Chunk, Returns Samples in It, 0 at the End of an Epoch
+// After an End Marker with error Set the Producer Has Exited, so There is No Next Epoch
+// Hands Back the Slot of the Previous Call and Takes the Other, No Allocation or Copy
+size_t nextChunk(Prefetcher *pf, const double **in, const double **target)
+{
+    PrefetchSlot *slot = &pf->slots[pf->head];
+
+    pthread_mutex_lock(&pf->lock);
+
+    if (pf->held >= 0)
+    {
+        pf->slots[pf->held].full = 0;
+        pf->held = -1;
+        pthread_cond_broadcast(&pf->cond);
+    }
+
+    if (!slot->full)
+    {
+        double start = now();
+
+        while (!slot->full)
+            pthread_cond_wait(&pf->cond, &pf->lock);
+
+        pf->wait += now() - start;
+    }
+
+    pf->held = pf->head;
+    pf->head = (pf->head + 1) % PrefetchSlots;
+
+    pthread_mutex_unlock(&pf->lock);
+
+    *in = slot->in;
+    *target = slot->target;
+
+    return slot->rows;
+}
+
+// Function to Check Whether the Dataset Stopped on an Error, Safe While the Producer Runs
+int prefetchFailed(Prefetcher *pf)
+{
+    pthread_mutex_lock(&pf->lock);
+    const int error = pf->error;
+    pthread_mutex_unlock(&pf->lock);
+
+    return error;
+}
@@ -0,0 +1,57 @@
+// ********************************************************************************
+// Double-Buffered Dataset Prefetch on a Producer Thread
+// ********************************************************************************
+
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "dataset.h"
+
+// Definitions - Macros
+#define PrefetchSlots 2                 // One Chunk Trains While the Other Fills
+
+// One Pre-Allocated Chunk Buffer
+typedef struct
+{
+    double *in;                 // Inputs [chunk][in_n]
+    double *target;             // Targets [chunk][out_n]
+    size_t rows;                // Samples Held, 0 Marks the End of an Epoch
+    int full;                   // Set by the Producer, Cleared When the Consumer is Done With It
+} PrefetchSlot;
+
+// A Producer Thread Reading and Shuffling Chunks of a Dataset Ahead of Training
+// It Owns the Dataset Until freePrefetcher(), so Only nextChunk() May Be Used Meanwhile
+typedef struct
+{
+    Dataset *ds;
+    int shuffle;                // Shuffle Samples Within Each Chunk
+    uint64_t seed;              // Seed of the Sample Order, a New Order Every Chunk and Epoch
+    uint64_t epoch;             // Epoch the Producer is Reading, Keys Its Shuffles
+    PrefetchSlot slots[PrefetchSlots];
+    int head;                   // Slot the Consumer Takes Next
+    int held;                   // Slot the Consumer Holds, -1 if None
+    int stop;                   // Set to Make the Producer Exit
+    int error;                  // Set with the End Marker When the Dataset Stopped on an Error
+    double wait;                // Seconds the Consumer Spent Waiting for Data
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} Prefetcher;
+
+// Construction and Destruction, the Producer Starts on Epoch first_epoch at Once
+// Each Chunk's Order Depends Only on (seed, Epoch, Chunk), so a Resumed Run Sees the Same Orders
+Prefetcher *createPrefetcher(Dataset *ds, int shuffle, uint64_t seed, uint64_t first_epoch);
+void freePrefetcher(Prefetcher *pf);
+
+// Function to Get the Next Chunk, Returns Samples in It, 0 at the End of an Epoch
+// The Call After the End Marker Starts the Next Epoch, Pointers Stay Valid Until the Next Call
+size_t nextChunk(Prefetcher *pf, const double **in, const double **target);
+
+// Function to Check Whether the Dataset Stopped on an Error, Safe While the Producer Runs
+int prefetchFailed(Prefetcher *pf);
+
+#endif
@@ -0,0 +1,276 @@
+// ********************************************************************************
+// Quantized int8 Inference for Trained Networks
+// ********************************************************************************
+
+#define _POSIX_C_SOURCE 200112L
+
+// Include Libraries
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "quant.h"
+
+// *******************************************************************
+#pragma GCC optimize("O3","unroll-loops","omit-frame-pointer","inline", "unsafe-math-optimizations")
+//************************************************************
+
+// Definitions - Macros
+#define RoundUp(n, m) ((((n) + (m) - 1) / (m)) * (m))
+
+// Integer Dot Products Are Cloned for the Baseline, AVX2 and AVX-512 Levels, Where the
+// Compiler Widens int8 Pairs Straight into int32 Multiply-Add Instructions
+#define QuantTargets __attribute__((target_clones("default", "arch=x86-64-v3", "arch=x86-64-v4")))
+
+// ***********************************
+// Helper Functions
+// ***********************************
+
+// Helper Function to Round to the Nearest int8 Code
+static inline int8_t quantize(float x)
+{
+    return (int8_t)(x + (x >= 0 ? 0.5f : -0.5f));
+}
+
+// Helper Function to Find the Sigmoid Table Cell of a Pre-Activation Value
+static inline int lutIndex(float d)
+{
+    int k = (int)((d + SigmoidLutRange) * (SigmoidLutN / (2 * SigmoidLutRange)));
+
+    return (k < 0) ? 0 : (k >= SigmoidLutN ? SigmoidLutN - 1 : k);
+}
+
+// Helper Function to Run One Quantized Layer, D = (W x) * Row Scale * Input Scale + Bias
+QuantTargets static void quantLayer(const QuantLayer *layer, const int8_t *restrict x, float x_scale, float *restrict D)
+{
+    for (int i = 0; i < layer->out; i++)
+    {
+        const int8_t *w = __builtin_assume_aligned(layer->W + (size_t)i * layer->stride, QuantPad);
+        int32_t sum = 0;
+
+        for (int j = 0; j < layer->stride; j++)     // Padding of x is Zero
+            sum += (int32_t)w[j] * x[j];
+
+        D[i] = (float)sum * layer->scale[i] * x_scale + layer->bias[i];
+    }
+}
+
+// ***********************************
+// Construction and Destruction
+// ***********************************
+
+// Function to Quantize a Trained Network of Any Precision
+// Each Row Gets the Scale Mapping Its Largest Weight to QuantLevels
+QuantNetwork *quantizeNN(const Network *net)
+{
+    QuantNetwork *q = alignedAlloc(sizeof(QuantNetwork));
+    if (q == NULL)
+        return NULL;
+
+    q->n_layers = net->n_layers;
+    for (int l = 0; l <= net->n_layers; l++)
+        q->widths[l] = net->widths[l];
+
+    for (int l = 0; l < net->n_layers; l++)
+    {
+        QuantLayer *ql = &q->layers[l];
+
+        ql->in = net->layers[l].in;
+        ql->out = net->layers[l].out;
+        ql->stride = RoundUp(ql->in, QuantPad);
+
+        q->bytes += (size_t)ql->out * ql->stride + 2 * RoundUp(ql->out * sizeof(float), CacheLine);
+    }
+
+    q->arena = alignedAlloc(q->bytes);
+    if (q->arena == NULL)
+    {
+        free(q);
+        return NULL;
+    }
+
+    char *p = q->arena;
+    for (int l = 0; l < net->n_layers; l++)
+    {
+        const Layer *layer = &net->layers[l];
+        QuantLayer *ql = &q->layers[l];
+
+        ql->W = (int8_t *)p;        p += (size_t)ql->out * ql->stride;
+        ql->scale = (float *)p;     p += RoundUp(ql->out * sizeof(float), CacheLine);
+        ql->bias = (float *)p;      p += RoundUp(ql->out * sizeof(float), CacheLine);
+
+        for (int i = 0; i < ql->out; i++)
+        {
+            size_t row = (size_t)i * layer->stride;
+            double wmax = 0;
+
+            for (int j = 0; j <= ql->in; j++)
+            {
+                double w = (layer->W != NULL) ? layer->W[row + j] : layer->Wf[row + j];
+
+                if (j == ql->in)
+                    ql->bias[i] = (float)w;
+                else if (fabs(w) > wmax)
+                    wmax = fabs(w);
+            }
+
+            ql->scale[i] = (wmax > 0) ? (float)(wmax / QuantLevels) : 1.0f;
+
+            for (int j = 0; j < ql->in; j++)
+            {
+                double w = (layer->W != NULL) ? layer->W[row + j] : layer->Wf[row + j];
+                ql->W[(size_t)i * ql->stride + j] = quantize((float)(w / ql->scale[i]));
+            }
+        }
+    }
+
+    // Sigmoid Sampled at Cell Centers, as Values and as Activation Codes
+
+    for (int k = 0; k < SigmoidLutN; k++)
+    {
+        double x = -SigmoidLutRange + (k + 0.5) * (2 * SigmoidLutRange / SigmoidLutN);
+
+        q->lut[k] = (float)sigmoid(x);
+        q->lut_q[k] = quantize(q->lut[k] * QuantLevels);
+    }
+
+    return q;
+}
+
+// Function to Release a Quantized Network
+void freeQuantNN(QuantNetwork *q)
+{
+    if (q == NULL)
+        return;
+
+    free(q->arena);
+    free(q);
+}
+
+// Function to Create Activation Buffers for a Quantized Network
+QuantWorkspace *createQuantWorkspace(const QuantNetwork *q)
+{
+    QuantWorkspace *qws = alignedAlloc(sizeof(QuantWorkspace));
+    if (qws == NULL)
+        return NULL;
+
+    size_t bytes = 0;
+    int widest = 0;
+
+    for (int l = 0; l < q->n_layers; l++)
+    {
+        bytes += RoundUp(q->widths[l], QuantPad);
+        if (q->widths[l + 1] > widest)
+            widest = q->widths[l + 1];
+    }
+
+    bytes += RoundUp(widest * sizeof(float), CacheLine) + RoundUp(q->widths[q->n_layers] * sizeof(double), CacheLine);
+
+    qws->arena = alignedAlloc(bytes);
+    if (qws->arena == NULL)
+    {
+        free(qws);
+        return NULL;
+    }
+
+    char *p = qws->arena;
+    qws->n_layers = q->n_layers;
+
+    for (int l = 0; l < q->n_layers; l++)
+    {
+        qws->X[l] = (int8_t *)p;
+        p += RoundUp(q->widths[l], QuantPad);
+    }
+
+    qws->D = (float *)p;    p += RoundUp(widest * sizeof(float), CacheLine);
+    qws->out = (double *)p;
+
+    return qws;
+}
+
+// Function to Release a Quantized Workspace
+void freeQuantWorkspace(QuantWorkspace *qws)
+{
+    if (qws == NULL)
+        return;
+
+    free(qws->arena);
+    free(qws);
+}
+
+// ***********************************
+// Inference
+// ***********************************
+
+// Function to Run the Forward Pass, Returns the Output Layer Values
+// The Input Gets a Per-Sample Scale, Hidden Activations in [0, 1] the Fixed Scale 1 / QuantLevels
+const double *activateQuantNN(const QuantNetwork *q, QuantWorkspace *qws, const double *in)
+{
+    const int L = q->n_layers;
+    float amax = 0;
+
+    for (int i = 0; i < q->widths[0]; i++)
+        amax = (fabsf((float)in[i]) > amax) ? fabsf((float)in[i]) : amax;
+
+    float x_scale = (amax > 0) ? amax / QuantLevels : 1.0f;
+
+    for (int i = 0; i < q->widths[0]; i++)
+        qws->X[0][i] = quantize((float)in[i] / x_scale);
+
+    for (int l = 0; l < L; l++)
+    {
+        const QuantLayer *layer = &q->layers[l];
+
+        quantLayer(layer, qws->X[l], x_scale, qws->D);
+
+        if (l < L - 1)
+        {
+            for (int i = 0; i < layer->out; i++)    // Sigmoid Straight to Codes
+                qws->X[l + 1][i] = q->lut_q[lutIndex(qws->D[i])];
+
+            x_scale = 1.0f / QuantLevels;
+        }
+        else
+        {
+            for (int i = 0; i < layer->out; i++)
+                qws->out[i] = q->lut[lutIndex(qws->D[i])];
+        }
+    }
+
+    return qws->out;
+}
+
+// Function to Compare Quantized and Source Outputs over n Samples of [n][width] Rows
+QuantReport compareQuantNN(const Network *net, Workspace *ws, const QuantNetwork *q, QuantWorkspace *qws,
+                           const double *in, const double *target, int n)
+{
+    const int in_n = net->widths[0];
+    const int out_n = net->widths[net->n_layers];
+    QuantReport r = { 0, 0, 0, 0 };
+
+    for (int s = 0; s < n; s++)
+    {
+        const double *t = target + (size_t)s * out_n;
+
+        activateNN(net, ws, in + (size_t)s * in_n);
+        r.error += calcError(net, ws, t);
+
+        const double *ref = outputNN(net, ws);
+        const double *out = activateQuantNN(q, qws, in + (size_t)s * in_n);
+
+        for (int i = 0; i < out_n; i++)
+        {
+            double diff = fabs(out[i] - ref[i]);
+
+            r.error_quant += 0.5 * (t[i] - out[i]) * (t[i] - out[i]);
+            r.mean_diff += diff;
+            r.max_diff = (diff > r.max_diff) ? diff : r.max_diff;
+        }
+    }
+
+    r.error /= n;
+    r.error_quant /= n;
+    r.mean_diff /= (double)n * out_n;
+
+    return r;
+}
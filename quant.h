@@ -0,0 +1,74 @@
+// ********************************************************************************
+// Quantized int8 Inference for Trained Networks
+// ********************************************************************************
+
+#ifndef QUANT_H
+#define QUANT_H
+
+#include <stdint.h>
+
+#include "network.h"
+
+// Definitions - Macros
+#define QuantPad 16                     // int8 Rows Are Padded to Whole 16-Byte Vectors
+#define QuantLevels 127                 // Largest int8 Code of a Weight or Activation
+#define SigmoidLutN 4096                // Entries of the Sigmoid Lookup Table
+#define SigmoidLutRange 12.0f           // Table Covers [-SigmoidLutRange, SigmoidLutRange)
+
+// One Quantized Layer, Row i of W Holds int8 Codes of Neuron i's Weights, w = code * scale[i]
+// Biases Stay float, so Inputs Need No Bias Slot
+typedef struct
+{
+    int in;
+    int out;
+    int stride;             // Padded Row Length of W in Bytes
+    int8_t *W;              // Weights [out][stride], Points into Arena
+    float *scale;           // Per-Row Scales [out]
+    float *bias;            // Per-Row Biases [out]
+} QuantLayer;
+
+// Forward-Only Copy of a Network, a Quarter the Size of Its float Weights
+typedef struct
+{
+    int n_layers;
+    int widths[MaxLayers];
+    QuantLayer layers[MaxLayers - 1];
+    void *arena;                        // Single Aligned Allocation Backing All Layers
+    size_t bytes;                       // Size of Arena
+    float lut[SigmoidLutN];             // Sigmoid at the Center of Each Table Cell
+    int8_t lut_q[SigmoidLutN];          // The Same, as Activation Codes (sigmoid * QuantLevels)
+} QuantNetwork;
+
+// Activation Codes and Pre-Activation Values of One Quantized Pass
+typedef struct
+{
+    int n_layers;
+    int8_t *X[MaxLayers];               // Codes of Layer Inputs, Padded with Zeros
+    float *D;                           // Pre-Activation Values of the Widest Layer
+    double *out;                        // Outputs of Last Pass
+    void *arena;
+} QuantWorkspace;
+
+// Accuracy of a Quantized Network Against Its Source on a Set of Samples
+typedef struct
+{
+    double error;                       // Mean calcError() of the Source Network
+    double error_quant;                 // Mean Error of the Quantized Network
+    double mean_diff;                   // Mean Absolute Output Difference
+    double max_diff;                    // Largest Absolute Output Difference
+} QuantReport;
+
+// Construction and Destruction
+QuantNetwork *quantizeNN(const Network *net);
+void freeQuantNN(QuantNetwork *q);
+QuantWorkspace *createQuantWorkspace(const QuantNetwork *q);
+void freeQuantWorkspace(QuantWorkspace *qws);
+
+// Function to Run the Forward Pass, Returns the Output Layer Values
+const double *activateQuantNN(const QuantNetwork *q, QuantWorkspace *qws, const double *in);
+
+// Function to Compare Quantized and Source Outputs over n Samples of [n][width] Rows
+QuantReport compareQuantNN(const Network *net, Workspace *ws, const QuantNetwork *q, QuantWorkspace *qws,
+                           const double *in, const double *target, int n);
+
+#endif
@@ -0,0 +1,52 @@
+// ********************************************************************************
+// Counter-Based Random Numbers (Philox4x32-10) Keyed by Seed, Stream and Index
+// ********************************************************************************
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// Definitions - Macros
+#define PhiloxM0 0xD2511F53u        // Round Multipliers
+#define PhiloxM1 0xCD9E8D57u
+#define PhiloxW0 0x9E3779B9u        // Key Schedule Increments
+#define PhiloxW1 0xBB67AE85u
+#define PhiloxRounds 10
+
+// Independent Streams Drawn from the Same Seed
+typedef enum
+{
+    RngWeights,         // Initial Weights, Indexed by Position in the Weight Arena
+    RngInputs,          // Generated Input Vectors, Indexed by Element
+    RngOutputs,         // Generated Output Vectors, Indexed by Element
+    RngShuffle          // Sample Order, Indexed by Round * Samples + Position
+} RngStream;
+
+// Helper Function to Get a Uniform Double in [0, 1) for Element index of a Stream
+// The Value Depends Only on (seed, stream, index), Never on Call Order or the Calling
+// Thread, so Any Loop Schedule Fills an Array Identically, with No Shared State
+static inline double rngUniform(uint64_t seed, RngStream stream, uint64_t index)
+{
+    uint32_t c0 = (uint32_t)index, c1 = (uint32_t)(index >> 32), c2 = (uint32_t)stream, c3 = 0;
+    uint32_t k0 = (uint32_t)seed, k1 = (uint32_t)(seed >> 32);
+
+    for (int r = 0; r < PhiloxRounds; r++)
+    {
+        uint64_t p0 = (uint64_t)PhiloxM0 * c0;
+        uint64_t p1 = (uint64_t)PhiloxM1 * c2;
+
+        c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        c1 = (uint32_t)p1;
+        c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c3 = (uint32_t)p0;
+
+        k0 += PhiloxW0;
+        k1 += PhiloxW1;
+    }
+
+    // Top 53 Bits of the First Two Output Words Fill the Mantissa
+    return (double)((((uint64_t)c0 << 32) | c1) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+#endif
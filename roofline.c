@@ -0,0 +1,333 @@
+// ********************************************************************************
+// Analytic FLOP and Byte Counts per Phase, Measured Machine Peaks and Roofline Report
+// ********************************************************************************
+
+#define _GNU_SOURCE     // sysconf() Cache Sizes
+
+// Include Libraries
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "roofline.h"
+
+// *******************************************************************
+#pragma GCC optimize("O3","unroll-loops","omit-frame-pointer","inline")
+//************************************************************
+
+// Definitions - Macros
+#define FmaChains 12                    // Independent Accumulators, Enough to Hide FMA Latency
+#define FmaIters (1L << 20)             // Iterations of All Chains per Trial
+#define TriadTarget ((size_t)1 << 30)   // Bytes a Triad Trial Moves, Repeating Small Working Sets
+#define ProbeTrials 5                   // Best Trial is Kept
+#define MemoryProbe ((size_t)256 << 20) // Triad Working Set Far Beyond Any Cache
+
+#define TargetSSE2 __attribute__((target("sse2")))
+#define TargetAVX2 __attribute__((target("avx2,fma")))
+#define TargetAVX512 __attribute__((target("avx512f,avx2,fma")))
+
+// Cache Sizes Assumed Where the System Does Not Report Them
+static const size_t default_capacity[MemoryLevels - 1] = { (size_t)32 << 10, (size_t)256 << 10 };
+static const char *level_names[MemoryLevels] = { "L1", "L2", "Memory" };
+
+// Every Probe Leaves Its Result Here, so None of Its Work Can Be Optimized Away
+static volatile double probe_sink;
+
+// ***********************************
+// Helper Functions
+// ***********************************
+
+// Helper Function to Get Monotonic Time in Seconds
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+// Helper Function to Get the Name of a Memory Level
+const char *memoryLevelName(int level)
+{
+    return (level >= 0 && level < MemoryLevels) ? level_names[level] : "unknown";
+}
+
+// Helper Function to Get the Capacity of a Cache Level, the Last Level Being Memory, Unbounded
+static size_t levelCapacity(int level)
+{
+    const int names[MemoryLevels - 1] = { _SC_LEVEL1_DCACHE_SIZE, _SC_LEVEL2_CACHE_SIZE };
+
+    if (level >= MemoryLevels - 1)
+        return SIZE_MAX;
+
+    long bytes = sysconf(names[level]);
+
+    return (bytes > 0) ? (size_t)bytes : default_capacity[level];
+}
+
+// Helper Function to Get the Bytes of One Scalar of the Network's Weights
+static size_t elementBytes(const Network *net)
+{
+    return (net->precision == PrecisionDouble) ? sizeof(double) : sizeof(float);
+}
+
+// ***********************************
+// Cost Model
+// ***********************************
+
+// Function to Count the Work of Each Phase for One Sample and One Call
+// Weights Are Read over Their Padded Rows, as the Kernels Do, but Only Real Weights Count as FLOPs
+// Single-Sample Passes Fuse Hidden Deltas into the Update Sweep, So Their Work is Charged to Update,
+// Batched Passes Compute Them Separately, Streaming the Weights Once More, and Charge Them to Deltas
+void phaseCosts(const Network *net, int batch, PhaseCost cost[Phases])
+{
+    const int fused = (batch <= 1);
+    const double e = (double)elementBytes(net);
+    const int out_n = net->widths[net->n_layers];
+
+    memset(cost, 0, Phases * sizeof(PhaseCost));
+
+    for (int l = 0; l < net->n_layers; l++)
+    {
+        const Layer *layer = &net->layers[l];
+        const double in = layer->in + 1;        // Bias Included
+        const double out = layer->out;
+        const double weights = out * layer->stride * e;
+
+        // Forward, One Dot Product per Neuron, Then Its Pre-Activation and Output Written
+        cost[PhaseForward].flops += 2 * in * out;
+        cost[PhaseForward].bytes += (in + 2 * out) * e;
+        cost[PhaseForward].call_bytes += weights;
+
+        // Update, One Multiply-Add per Weight, Each Weight Read and Written Back
+        cost[PhaseUpdate].flops += 2 * in * out + out;
+        cost[PhaseUpdate].bytes += (in + out) * e;
+        cost[PhaseUpdate].call_bytes += 2 * weights;
+
+        // Deltas of Every Hidden Layer Come Back Through the Weights of the Layer Above,
+        // the Fused Sweep Reuses the Weights and Deltas the Update Already Reads
+        if (l > 0 && fused)
+        {
+            cost[PhaseUpdate].flops += 2 * out * layer->in + 3 * layer->in;
+            cost[PhaseUpdate].bytes += 2 * layer->in * e;
+        }
+        else if (l > 0)
+        {
+            cost[PhaseDeltas].flops += 2 * out * layer->in + 3 * layer->in;
+            cost[PhaseDeltas].bytes += (out + 2 * layer->in) * e;
+            cost[PhaseDeltas].call_bytes += weights;
+        }
+    }
+
+    // Output Deltas and the Error Both Compare Outputs with double Targets
+    cost[PhaseDeltas].flops += 4 * out_n;
+    cost[PhaseDeltas].bytes += out_n * (sizeof(double) + 2 * e);
+    cost[PhaseError].flops += 3 * out_n;
+    cost[PhaseError].bytes += out_n * 2 * sizeof(double);
+}
+
+// ***********************************
+// FMA Probe
+// ***********************************
+
+// One Probe per Instruction Set and Precision, acc = acc * m + a on Independent Register Chains,
+// Contracted to FMAs Where the Target Has Them, Returns FLOPs Done
+#define FmaProbe(name, target, type, lanes)                                         \
+    target static double name(type m, type a)                                       \
+    {                                                                               \
+        typedef type Vec __attribute__((vector_size(lanes * sizeof(type))));        \
+        Vec acc[FmaChains];                                                         \
+                                                                                    \
+        for (int c = 0; c < FmaChains; c++)                                         \
+            acc[c] = (Vec){ 0 } + (type)c;                                          \
+                                                                                    \
+        for (long i = 0; i < FmaIters; i++)                                         \
+        {                                                                           \
+            for (int c = 0; c < FmaChains; c++)                                     \
+                acc[c] = acc[c] * m + a;                                            \
+        }                                                                           \
+                                                                                    \
+        for (int c = 1; c < FmaChains; c++)                                         \
+            acc[0] += acc[c];                                                       \
+                                                                                    \
+        probe_sink = acc[0][0];                                                     \
+                                                                                    \
+        return 2.0 * lanes * FmaChains * FmaIters;                                  \
+    }
+
+FmaProbe(fmaScalarD, , double, 1)
+FmaProbe(fmaSSE2D, TargetSSE2, double, 2)
+FmaProbe(fmaAVX2D, TargetAVX2, double, 4)
+FmaProbe(fmaAVX512D, TargetAVX512, double, 8)
+FmaProbe(fmaScalarF, , float, 1)
+FmaProbe(fmaSSE2F, TargetSSE2, float, 4)
+FmaProbe(fmaAVX2F, TargetAVX2, float, 8)
+FmaProbe(fmaAVX512F, TargetAVX512, float, 16)
+
+// Helper Function to Measure GFLOP/s on the Instruction Set the Network's Kernels Use
+// float Networks Count float Lanes, Mixed Ones Accumulate in double so Count double Lanes
+static double fmaPeak(const Network *net)
+{
+    const char *isa = net->simd->name;
+    const int single = (net->precision == PrecisionFloat);
+    const int level = !strcmp(isa, "avx512") ? 3 : !strcmp(isa, "avx2") ? 2 : !strcmp(isa, "sse2") ? 1 : 0;
+    double best = 0;
+
+    for (int trial = 0; trial < ProbeTrials; trial++)
+    {
+        double flops = 0;
+        double start = now();
+
+        // Multiplier Just Below 1 Keeps Every Chain Bounded and Clear of Denormals
+        if (single)
+        {
+            const float m = 0.999999f, a = 1e-6f;
+            flops = (level == 3) ? fmaAVX512F(m, a) : (level == 2) ? fmaAVX2F(m, a) :
+                    (level == 1) ? fmaSSE2F(m, a) : fmaScalarF(m, a);
+        }
+        else
+        {
+            const double m = 0.999999999, a = 1e-9;
+            flops = (level == 3) ? fmaAVX512D(m, a) : (level == 2) ? fmaAVX2D(m, a) :
+                    (level == 1) ? fmaSSE2D(m, a) : fmaScalarD(m, a);
+        }
+
+        double elapsed = now() - start;
+
+        if (elapsed > 0 && flops / elapsed > best)
+            best = flops / elapsed;
+    }
+
+    return best * 1e-9;
+}
+
+// ***********************************
+// Bandwidth Probe
+// ***********************************
+
+// Helper Function for the STREAM Triad a[i] = b[i] + s * c[i], Counted as 3 Arrays Moved
+static void triad(double *restrict a, const double *restrict b, const double *restrict c, double s, size_t n)
+{
+    a = __builtin_assume_aligned(a, CacheLine);
+    b = __builtin_assume_aligned(b, CacheLine);
+    c = __builtin_assume_aligned(c, CacheLine);
+
+    for (size_t i = 0; i < n; i++)
+        a[i] = b[i] + s * c[i];
+}
+
+// Helper Function to Measure Triad GB/s with All Three Arrays Together Filling bytes
+static double triadBandwidth(size_t bytes)
+{
+    const size_t n = bytes / (3 * sizeof(double));
+    const size_t moved = 3 * n * sizeof(double);
+    const int reps = (moved < TriadTarget) ? (int)(TriadTarget / moved) : 1;
+    double *a = alignedAlloc(n * sizeof(double));
+    double *b = alignedAlloc(n * sizeof(double));
+    double *c = alignedAlloc(n * sizeof(double));
+    double best = -1;
+
+    if (a != NULL && b != NULL && c != NULL)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            b[i] = 1.0;
+            c[i] = 2.0;
+        }
+
+        triad(a, b, c, 0.5, n);     // Pages and Lines Touched Before Timing
+
+        best = 0;
+        for (int trial = 0; trial < ProbeTrials; trial++)
+        {
+            double start = now();
+
+            // A New Scalar Each Repetition, so No Pass Can Be Elided
+            for (int r = 0; r < reps; r++)
+                triad(a, b, c, 0.5 + r * 1e-12, n);
+
+            double elapsed = now() - start;
+
+            probe_sink = a[n / 2];
+
+            if (elapsed > 0 && (double)moved * reps / elapsed > best)
+                best = (double)moved * reps / elapsed;
+        }
+    }
+
+    free(a);
+    free(b);
+    free(c);
+
+    return best * 1e-9;
+}
+
+// Function to Measure FMA Throughput and Triad Bandwidth on the Calling Thread, Returns 0 on Success
+int probeMachine(const Network *net, MachinePeaks *peaks)
+{
+    memset(peaks, 0, sizeof(*peaks));
+
+    peaks->isa = net->simd->name;
+    peaks->gflops = fmaPeak(net);
+
+    // Cache Levels Are Probed at Half Their Capacity, so the Triad Sits Well Inside
+    for (int level = 0; level < MemoryLevels; level++)
+    {
+        peaks->capacity[level] = levelCapacity(level);
+        peaks->level_bytes[level] = (level < MemoryLevels - 1) ? peaks->capacity[level] / 2 : MemoryProbe;
+        peaks->gbytes[level] = triadBandwidth(peaks->level_bytes[level]);
+
+        if (peaks->gbytes[level] <= 0)
+            return -1;
+    }
+
+    return (peaks->gflops > 0) ? 0 : -1;
+}
+
+// ***********************************
+// Report
+// ***********************************
+
+// Function to Print Achieved GFLOP/s, GB/s and Fraction of Roofline per Phase
+// Every Sample Trained Passes Through Each Phase Once, and Each Call Streams the Weights Once,
+// so the Work of a Phase is Its Per-Sample Cost Times Samples Plus Its Per-Call Cost Times Calls
+// The Bandwidth Roof is That of the Smallest Level Holding the Weights and a Workspace for batch
+void printRoofline(const Network *net, int batch, const PhaseStats *stats, const MachinePeaks *peaks)
+{
+    PhaseCost cost[Phases];
+    const size_t working_set = net->n_weights * elementBytes(net) + workspaceBytes(net, batch);
+    int level = 0;
+
+    phaseCosts(net, batch, cost);
+
+    while (level < MemoryLevels - 1 && peaks->capacity[level] < working_set)
+        level++;
+
+    const double roof_bw = peaks->gbytes[level];
+
+    printf("Roofline: %s %s, Peak %.2f GFLOP/s per Thread, Triad", peaks->isa, precisionName(net->precision), peaks->gflops);
+    for (int m = 0; m < MemoryLevels; m++)
+        printf(" %s %.1f GB/s%s", level_names[m], peaks->gbytes[m], (m < MemoryLevels - 1) ? "," : "\n");
+    printf("Working Set %zu Bytes, Bandwidth Roof from %s, Ridge at %.2f FLOP/Byte\n", working_set, level_names[level],
+           peaks->gflops / roof_bw);
+    printf("%-10s %12s %10s %10s %12s %10s %8s\n", "Phase", "GFLOP/s", "GB/s", "FLOP/Byte", "Roof GFLOP/s", "Bound", "Roof");
+
+    for (int p = 0; p < Phases; p++)
+    {
+        const double seconds = statSeconds(stats->ticks[p]);
+        const double flops = cost[p].flops * stats->samples;
+        const double bytes = cost[p].bytes * stats->samples + cost[p].call_bytes * stats->calls[p];
+
+        if (seconds <= 0 || bytes <= 0)
+            continue;
+
+        const double intensity = flops / bytes;
+        const double roof = (intensity * roof_bw < peaks->gflops) ? intensity * roof_bw : peaks->gflops;
+        const double achieved = flops / seconds * 1e-9;
+
+        printf("%-10s %12.3f %10.2f %10.3f %12.3f %10s %7.1f%%\n", phaseName(p), achieved, bytes / seconds * 1e-9,
+               intensity, roof, (intensity * roof_bw < peaks->gflops) ? "Bandwidth" : "Compute", 100.0 * achieved / roof);
+    }
+}
@@ -0,0 +1,46 @@
+// ********************************************************************************
+// Analytic FLOP and Byte Counts per Phase, Measured Machine Peaks and Roofline Report
+// ********************************************************************************
+
+#ifndef ROOFLINE_H
+#define ROOFLINE_H
+
+#include "network.h"
+#include "stats.h"
+
+// Definitions - Macros
+#define MemoryLevels 3      // Cache Levels and Memory the Triad Probe Measures
+
+// Work One Phase Does, Split Into What Every Sample Costs and What Every Call Costs Once,
+// Which is the Weights a Batched Call Streams Regardless of Its Batch
+typedef struct
+{
+    double flops;           // Useful Floating Point Operations per Sample, Padding Excluded
+    double bytes;           // Activation, Delta and Target Bytes per Sample
+    double call_bytes;      // Weight Bytes per Call, Read Once (Twice When Updated)
+} PhaseCost;
+
+// Single Thread Peaks of This Machine, at the Network's Precision
+typedef struct
+{
+    const char *isa;                    // Instruction Set the FMA Probe Ran
+    double gflops;                      // FMA Throughput, Independent Chains in Registers
+    double gbytes[MemoryLevels];        // STREAM Triad Bandwidth per Level, Smallest First
+    size_t level_bytes[MemoryLevels];   // Triad Working Set Measured at Each Level
+    size_t capacity[MemoryLevels];      // Size of Each Cache Level, SIZE_MAX for Memory
+} MachinePeaks;
+
+// Helper Functions
+const char *memoryLevelName(int level);
+
+// Function to Count the Work of Each Phase for One Sample and One Call of a Pass over batch Samples
+void phaseCosts(const Network *net, int batch, PhaseCost cost[Phases]);
+
+// Function to Measure FMA Throughput and Triad Bandwidth on the Calling Thread, Returns 0 on Success
+int probeMachine(const Network *net, MachinePeaks *peaks);
+
+// Function to Print Achieved GFLOP/s, GB/s and Fraction of Roofline per Phase
+// Seconds Are Summed over Threads, so Rates Are per Thread and Compared to Single Thread Peaks
+void printRoofline(const Network *net, int batch, const PhaseStats *stats, const MachinePeaks *peaks);
+
+#endif
@@ -0,0 +1,461 @@
+// ********************************************************************************
+// Batch Inference Server, a Checkpointed Network Answering on a Unix Domain Socket
+// ********************************************************************************
+
+#define _POSIX_C_SOURCE 200809L
+
+// Include Libraries
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "network.h"
+#include "checkpoint.h"
+#include "serve.h"
+
+// Definitions - Macros
+#define DefaultMaxBatch 64              // Requests Coalesced into One Forward Pass
+#define DefaultMaxDelay 1000            // Microseconds the Oldest Queued Request May Wait for Company
+#define MaxClients 256                  // Connections Served at Once
+#define ReadBytes 65536                 // Bytes Read from a Connection per Call
+#define MaxPending (1 << 20)            // Unsent Response Bytes a Connection May Hold Before It is Dropped
+
+// One Client Connection, a Free Slot Has fd -1
+typedef struct
+{
+    int fd;
+    uint64_t id;                // Changes When the Slot is Reused, so Stale Requests Get No Answer
+    unsigned char *in;          // Partial Request Being Read [in_n doubles]
+    size_t in_fill;
+    unsigned char *out;         // Responses Not Yet Sent
+    size_t out_len;
+    size_t out_sent;
+    size_t out_cap;
+} Client;
+
+// Requests Waiting for the Next Forward Pass
+typedef struct
+{
+    int n;
+    double *in;                 // Inputs [max_batch][in_n]
+    int *client;                // Slot Each Request Came From
+    uint64_t *id;               // And the Connection Then in It
+    double first;               // Arrival Time of the Oldest
+} Queue;
+
+static volatile sig_atomic_t stopping = 0;
+
+// ***********************************
+// Helper Functions
+// ***********************************
+
+// Helper Function to Get Monotonic Time in Seconds
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+// Helper Function to Stop Serving on SIGINT or SIGTERM
+static void onSignal(int sig)
+{
+    (void)sig;
+    stopping = 1;
+}
+
+// Helper Function to Close a Connection and Free Its Slot
+static void dropClient(Client *c, int *connections)
+{
+    (*connections)--;
+    close(c->fd);
+    free(c->in);
+    free(c->out);
+    c->fd = -1;
+    c->in = c->out = NULL;
+}
+
+// Helper Function to Queue Bytes for a Connection and Send What the Socket Takes Now
+// Fails When the Connection Stops Reading and More Than MaxPending Bytes Would Be Waiting
+static int sendClient(Client *c, const void *bytes, size_t n)
+{
+    if (c->out_sent > 0 && n > 0)
+    {
+        // Move What is Still Unsent to the Front, so the Buffer Only Holds Pending Bytes
+        memmove(c->out, c->out + c->out_sent, c->out_len - c->out_sent);
+        c->out_len -= c->out_sent;
+        c->out_sent = 0;
+    }
+
+    if (c->out_len + n > MaxPending)
+        return -1;
+
+    if (c->out_len + n > c->out_cap)
+    {
+        size_t cap = (c->out_cap > 0) ? c->out_cap : 4096;
+        while (cap < c->out_len + n)
+            cap *= 2;
+
+        unsigned char *out = realloc(c->out, cap);
+        if (out == NULL)
+            return -1;
+
+        c->out = out;
+        c->out_cap = cap;
+    }
+
+    if (n > 0)      // A Flush Passes No Bytes, and out May Not Be Allocated Yet
+    {
+        memcpy(c->out + c->out_len, bytes, n);
+        c->out_len += n;
+    }
+
+    while (c->out_sent < c->out_len)
+    {
+        ssize_t sent = send(c->fd, c->out + c->out_sent, c->out_len - c->out_sent, MSG_NOSIGNAL);
+
+        if (sent < 0)
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+
+        c->out_sent += (size_t)sent;
+    }
+
+    c->out_len = c->out_sent = 0;      // All Sent, Start the Buffer Over
+
+    return 0;
+}
+
+// Helper Function to Open the Listening Socket, Replacing a Stale One
+static int listenOn(const char *path)
+{
+    struct sockaddr_un addr;
+
+    if (strlen(path) >= sizeof(addr.sun_path))
+        return -1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+
+    unlink(path);
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, MaxClients) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+
+    return fd;
+}
+
+// ***********************************
+// Micro-Batching
+// ***********************************
+
+// Helper Function to Answer Every Queued Request with One Batched Forward Pass
+static void runBatch(const Network *net, Workspace *ws, Queue *q, Client *clients, int *connections, uint64_t *served,
+                     uint64_t *batches)
+{
+    const int out_n = net->widths[net->n_layers];
+
+    if (q->n == 0)
+        return;
+
+    activateNNBatch(net, ws, q->in, q->n);
+
+    for (int b = 0; b < q->n; b++)
+    {
+        Client *c = &clients[q->client[b]];
+
+        if (c->fd >= 0 && c->id == q->id[b] && sendClient(c, outputNNBatch(net, ws, b), out_n * sizeof(double)) != 0)
+            dropClient(c, connections);
+    }
+
+    *served += q->n;
+    *batches += 1;
+    q->n = 0;
+}
+
+// Helper Function to Read What a Connection Has Sent, Queueing Each Whole Request
+// A Full Queue is Run at Once, so No Request Waits for Room, Returns 1 If That Batch Dropped This Connection
+static int readClient(const Network *net, Workspace *ws, Queue *q, Client *clients, int k, int max_batch,
+                      int *connections, uint64_t *served, uint64_t *batches)
+{
+    Client *c = &clients[k];
+    const size_t request = net->widths[0] * sizeof(double);
+    unsigned char buf[ReadBytes];
+
+    for (;;)
+    {
+        ssize_t got = read(c->fd, buf, sizeof(buf));
+
+        if (got == 0)
+            return -1;
+        if (got < 0)
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+
+        for (size_t p = 0; p < (size_t)got; )
+        {
+            size_t take = (request - c->in_fill < (size_t)got - p) ? request - c->in_fill : (size_t)got - p;
+
+            memcpy(c->in + c->in_fill, buf + p, take);
+            c->in_fill += take;
+            p += take;
+
+            if (c->in_fill < request)
+                break;
+
+            if (q->n == 0)
+                q->first = now();
+
+            memcpy(q->in + (size_t)q->n * net->widths[0], c->in, request);
+            q->client[q->n] = k;
+            q->id[q->n] = c->id;
+            q->n++;
+            c->in_fill = 0;
+
+            if (q->n == max_batch)
+            {
+                runBatch(net, ws, q, clients, connections, served, batches);
+
+                if (c->fd < 0)
+                    return 1;
+            }
+        }
+    }
+}
+
+// Helper Function to Print Usage
+static void printUsage(const char *name)
+{
+    fprintf(stderr, "Usage: %s -m file [-u path] [-b batch] [-q usec]\n", name);
+    fprintf(stderr, "  -m file     Checkpoint of the Network to Serve\n");
+    fprintf(stderr, "  -u path     Unix Domain Socket to Listen On (Default %s)\n", DefaultSocket);
+    fprintf(stderr, "  -b batch    Most Requests per Forward Pass (Default %d)\n", DefaultMaxBatch);
+    fprintf(stderr, "  -q usec     Longest a Request Waits for Others to Batch With, 0 Batches Only What Arrives Together (Default %d)\n", DefaultMaxDelay);
+}
+
+// Driver Function
+// One Thread Polls Every Connection, Queues Whole Requests as They Arrive, and Runs the Queue
+// When It Holds batch Requests or Its Oldest Has Waited usec, Trading Latency for Throughput
+int main(int argc, char *argv[])
+{
+    const char *model_path = NULL;
+    const char *socket_path = DefaultSocket;
+    int max_batch = DefaultMaxBatch;
+    long max_delay = DefaultMaxDelay;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:u:b:q:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'm':
+                model_path = optarg;
+                break;
+            case 'u':
+                socket_path = optarg;
+                break;
+            case 'b':
+                max_batch = atoi(optarg);
+                break;
+            case 'q':
+                max_delay = atol(optarg);
+                break;
+            default:
+                printUsage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (model_path == NULL || max_batch < 1 || max_delay < 0)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    TrainState state;
+    Network *net = loadCheckpoint(model_path, &state);
+
+    if (net == NULL)
+    {
+        fprintf(stderr, "Failed to Load Checkpoint %s!\n", model_path);
+        return 1;
+    }
+
+    const int in_n = net->widths[0];
+    const int out_n = net->widths[net->n_layers];
+
+    Workspace *ws = createWorkspace(net, max_batch);
+    Client *clients = calloc(MaxClients, sizeof(Client));
+    struct pollfd *fds = calloc(MaxClients + 1, sizeof(struct pollfd));
+    int *slot_of = calloc(MaxClients + 1, sizeof(int));        // Client Slot of Each Polled fd
+    Queue q = { 0, malloc((size_t)max_batch * in_n * sizeof(double)), malloc(max_batch * sizeof(int)),
+                malloc(max_batch * sizeof(uint64_t)), 0 };
+
+    if (ws == NULL || clients == NULL || fds == NULL || slot_of == NULL || q.in == NULL || q.client == NULL || q.id == NULL)
+    {
+        fprintf(stderr, "Failed to Allocate Network!\n");
+        return 1;
+    }
+
+    for (int k = 0; k < MaxClients; k++)
+        clients[k].fd = -1;
+
+    int listen_fd = listenOn(socket_path);
+    if (listen_fd < 0)
+    {
+        fprintf(stderr, "Failed to Listen on %s!\n", socket_path);
+        return 1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onSignal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    printf("Serving %s (%d Inputs, %d Outputs, %s, Epoch %llu) on %s, Batches of Up to %d, %ld us Max Delay\n",
+           model_path, in_n, out_n, precisionName(net->precision), (unsigned long long)state.epoch, socket_path,
+           max_batch, max_delay);
+    fflush(stdout);
+
+    ServeHello hello;
+    memcpy(hello.magic, ServeMagic, sizeof(hello.magic));
+    hello.in_n = (uint32_t)in_n;
+    hello.out_n = (uint32_t)out_n;
+    hello.max_batch = (uint32_t)max_batch;
+
+    uint64_t next_id = 1;
+    uint64_t served = 0;
+    uint64_t batches = 0;
+    int connections = 0;
+
+    while (!stopping)
+    {
+        // Poll the Listener While There is Room, and Every Connection
+
+        int n_fds = 0;
+
+        if (connections < MaxClients)
+        {
+            fds[n_fds].fd = listen_fd;
+            fds[n_fds].events = POLLIN;
+            slot_of[n_fds++] = -1;
+        }
+
+        for (int k = 0; k < MaxClients; k++)
+        {
+            if (clients[k].fd < 0)
+                continue;
+
+            fds[n_fds].fd = clients[k].fd;
+            fds[n_fds].events = POLLIN | ((clients[k].out_len > clients[k].out_sent) ? POLLOUT : 0);
+            slot_of[n_fds++] = k;
+        }
+
+        // Sleep No Longer Than the Oldest Queued Request May Still Wait
+
+        int timeout = -1;
+
+        if (q.n > 0)
+        {
+            double left = q.first + max_delay * 1e-6 - now();
+            timeout = (left > 0) ? (int)(left * 1e3 + 0.999) : 0;
+        }
+
+        if (poll(fds, n_fds, timeout) < 0 && errno != EINTR)
+            break;
+
+        for (int f = 0; f < n_fds && !stopping; f++)
+        {
+            const int k = slot_of[f];
+
+            if (fds[f].revents == 0)
+                continue;
+
+            if (k < 0)
+            {
+                // New Connections, Each Greeted with the Network's Shape
+
+                int fd;
+                while (connections < MaxClients && (fd = accept(listen_fd, NULL, NULL)) >= 0)
+                {
+                    int s = 0;
+                    while (clients[s].fd >= 0)
+                        s++;
+
+                    Client *c = &clients[s];
+
+                    memset(c, 0, sizeof(*c));
+                    c->fd = fd;
+                    c->id = next_id++;
+                    c->in = malloc(in_n * sizeof(double));
+                    fcntl(fd, F_SETFL, O_NONBLOCK);
+                    connections++;
+
+                    if (c->in == NULL || sendClient(c, &hello, sizeof(hello)) != 0)
+                        dropClient(c, &connections);
+                }
+
+                continue;
+            }
+
+            Client *c = &clients[k];
+
+            if (c->fd < 0)
+                continue;
+
+            int failed = (fds[f].revents & (POLLERR | POLLNVAL)) != 0;
+
+            if (!failed && (fds[f].revents & POLLOUT))
+                failed = sendClient(c, NULL, 0) != 0;
+
+            if (!failed && (fds[f].revents & (POLLIN | POLLHUP)))
+                failed = readClient(net, ws, &q, clients, k, max_batch, &connections, &served, &batches) != 0;
+
+            if (failed && c->fd >= 0)
+                dropClient(c, &connections);
+        }
+
+        // Run the Queue Once Its Oldest Request Has Waited Long Enough
+
+        if (q.n > 0 && now() - q.first >= max_delay * 1e-6)
+            runBatch(net, ws, &q, clients, &connections, &served, &batches);
+    }
+
+    printf("Served %llu Requests in %llu Batches, %.2f per Batch\n", (unsigned long long)served,
+           (unsigned long long)batches, batches ? (double)served / batches : 0.0);
+
+    for (int k = 0; k < MaxClients; k++)
+        if (clients[k].fd >= 0)
+            dropClient(&clients[k], &connections);
+
+    close(listen_fd);
+    unlink(socket_path);
+
+    free(q.in);
+    free(q.client);
+    free(q.id);
+    free(slot_of);
+    free(fds);
+    free(clients);
+    freeWorkspace(ws);
+    freeNN(net);
+
+    return 0;
+}
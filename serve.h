@@ -0,0 +1,25 @@
+// ********************************************************************************
+// Wire Protocol of the Batch Inference Server, Shared with Its Client
+// ********************************************************************************
+
+#ifndef SERVE_H
+#define SERVE_H
+
+#include <stdint.h>
+
+// Definitions - Macros
+#define ServeMagic "EBPS"               // First Bytes the Server Sends on Every Connection
+#define DefaultSocket "/tmp/ebp.sock"   // Unix Domain Socket Path Unless Asked Otherwise
+
+// Sent by the Server When a Connection is Accepted
+// Then Each Request is in_n doubles, and Each Response out_n doubles,
+// Answered in Request Order per Connection, Any Number May Be in Flight
+typedef struct
+{
+    char magic[4];
+    uint32_t in_n;
+    uint32_t out_n;
+    uint32_t max_batch;         // Largest Micro-Batch the Server Forms
+} ServeHello;
+
+#endif
@@ -0,0 +1,338 @@
+// ********************************************************************************
+// Load Generator for the Batch Inference Server, Local Connections Only
+// ********************************************************************************
+
+#define _POSIX_C_SOURCE 200809L
+
+// Include Libraries
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "network.h"
+#include "checkpoint.h"
+#include "serve.h"
+#include "rng.h"
+
+// Definitions - Macros
+#define DefaultRequests 10000           // Requests Sent Across All Connections
+#define DefaultConnections 4            // Concurrent Connections, One Thread Each
+#define DefaultDepth 1                  // Requests Each Connection Keeps in Flight
+#define DefaultSeed 1
+
+// One Connection's Share of the Run
+typedef struct
+{
+    const char *path;
+    int in_n;
+    int out_n;
+    uint64_t seed;
+    uint64_t first;             // Index of Its First Request, Keys the Inputs
+    int n;                      // Requests It Sends
+    int depth;
+    double *latency;            // Seconds from Send to Response [n]
+    double *out;                // Responses [n][out_n]
+    int failed;
+} Connection;
+
+// ***********************************
+// Helper Functions
+// ***********************************
+
+// Helper Function to Get Monotonic Time in Seconds
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+// Helper Function to Fill the Input Vector of Request r
+static void makeInput(double *in, int in_n, uint64_t seed, uint64_t r)
+{
+    for (int i = 0; i < in_n; i++)
+        in[i] = rngUniform(seed, RngInputs, r * in_n + i);
+}
+
+// Helper Function to Send or Receive Exactly n Bytes, Returns 0 on Success
+static int sendAll(int fd, const void *bytes, size_t n)
+{
+    for (size_t done = 0; done < n; )
+    {
+        ssize_t sent = send(fd, (const char *)bytes + done, n - done, MSG_NOSIGNAL);
+        if (sent <= 0)
+            return -1;
+        done += (size_t)sent;
+    }
+
+    return 0;
+}
+
+static int recvAll(int fd, void *bytes, size_t n)
+{
+    for (size_t done = 0; done < n; )
+    {
+        ssize_t got = recv(fd, (char *)bytes + done, n - done, 0);
+        if (got <= 0)
+            return -1;
+        done += (size_t)got;
+    }
+
+    return 0;
+}
+
+// Helper Function to Connect to the Server and Read Its Hello, Returns the Socket or -1
+static int connectServer(const char *path, ServeHello *hello)
+{
+    struct sockaddr_un addr;
+
+    if (strlen(path) >= sizeof(addr.sun_path))
+        return -1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || recvAll(fd, hello, sizeof(*hello)) != 0 ||
+        memcmp(hello->magic, ServeMagic, sizeof(hello->magic)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+// Helper Function Run by Each Connection Thread
+// Keeps depth Requests in Flight, Sending the Next as Soon as the Oldest is Answered
+static void *runConnection(void *arg)
+{
+    Connection *c = arg;
+    ServeHello hello;
+    double *in = malloc(c->in_n * sizeof(double));
+    double *sent_at = malloc(c->depth * sizeof(double));
+    int fd = connectServer(c->path, &hello);
+
+    c->failed = (in == NULL || sent_at == NULL || fd < 0 || (int)hello.in_n != c->in_n || (int)hello.out_n != c->out_n);
+
+    int sent = 0;
+
+    for (int r = 0; r < c->n && !c->failed; r++)
+    {
+        while (sent < c->n && sent - r < c->depth)
+        {
+            makeInput(in, c->in_n, c->seed, c->first + sent);
+            sent_at[sent % c->depth] = now();
+            if (sendAll(fd, in, c->in_n * sizeof(double)) != 0)
+                c->failed = 1;
+            sent++;
+        }
+
+        if (c->failed || recvAll(fd, c->out + (size_t)r * c->out_n, c->out_n * sizeof(double)) != 0)
+        {
+            c->failed = 1;
+            break;
+        }
+
+        c->latency[r] = now() - sent_at[r % c->depth];
+    }
+
+    if (fd >= 0)
+        close(fd);
+    free(sent_at);
+    free(in);
+
+    return NULL;
+}
+
+// Helper Function to Compare Two Latencies for qsort
+static int compareDouble(const void *a, const void *b)
+{
+    const double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Helper Function to Print Usage
+static void printUsage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-u path] [-n requests] [-c connections] [-p depth] [-m file] [-s seed]\n", name);
+    fprintf(stderr, "  -u path     Unix Domain Socket of the Server (Default %s)\n", DefaultSocket);
+    fprintf(stderr, "  -n num      Requests Across All Connections (Default %d)\n", DefaultRequests);
+    fprintf(stderr, "  -c num      Concurrent Connections (Default %d)\n", DefaultConnections);
+    fprintf(stderr, "  -p num      Requests in Flight per Connection (Default %d)\n", DefaultDepth);
+    fprintf(stderr, "  -m file     Checkpoint the Server Loaded, Responses Are Checked Against a Local Pass\n");
+    fprintf(stderr, "  -s num      Seed of the Request Inputs (Default %d)\n", DefaultSeed);
+}
+
+// Driver Function
+int main(int argc, char *argv[])
+{
+    const char *socket_path = DefaultSocket;
+    const char *model_path = NULL;
+    int n_requests = DefaultRequests;
+    int n_connections = DefaultConnections;
+    int depth = DefaultDepth;
+    uint64_t seed = DefaultSeed;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "u:n:c:p:m:s:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'u':
+                socket_path = optarg;
+                break;
+            case 'n':
+                n_requests = atoi(optarg);
+                break;
+            case 'c':
+                n_connections = atoi(optarg);
+                break;
+            case 'p':
+                depth = atoi(optarg);
+                break;
+            case 'm':
+                model_path = optarg;
+                break;
+            case 's':
+                seed = strtoull(optarg, NULL, 10);
+                break;
+            default:
+                printUsage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (n_requests < 1 || n_connections < 1 || depth < 1 || n_connections > n_requests)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Learn the Network's Shape from the Server Before Starting the Threads
+
+    ServeHello hello;
+    int probe = connectServer(socket_path, &hello);
+
+    if (probe < 0)
+    {
+        fprintf(stderr, "Failed to Connect to %s!\n", socket_path);
+        return 1;
+    }
+
+    close(probe);
+
+    const int in_n = (int)hello.in_n;
+    const int out_n = (int)hello.out_n;
+
+    Connection *conns = calloc(n_connections, sizeof(Connection));
+    pthread_t *threads = malloc(n_connections * sizeof(pthread_t));
+    double *latency = malloc(n_requests * sizeof(double));
+    double *out = malloc((size_t)n_requests * out_n * sizeof(double));
+
+    if (conns == NULL || threads == NULL || latency == NULL || out == NULL)
+    {
+        fprintf(stderr, "Failed to Allocate Client!\n");
+        return 1;
+    }
+
+    // Split the Requests into Contiguous Runs, One per Connection
+
+    for (int k = 0, first = 0; k < n_connections; k++)
+    {
+        Connection *c = &conns[k];
+        const int n = n_requests / n_connections + (k < n_requests % n_connections);
+
+        c->path = socket_path;
+        c->in_n = in_n;
+        c->out_n = out_n;
+        c->seed = seed;
+        c->first = (uint64_t)first;
+        c->n = n;
+        c->depth = depth;
+        c->latency = latency + first;
+        c->out = out + (size_t)first * out_n;
+        first += n;
+    }
+
+    const double start = now();
+
+    for (int k = 0; k < n_connections; k++)
+        pthread_create(&threads[k], NULL, runConnection, &conns[k]);
+
+    int failed = 0;
+
+    for (int k = 0; k < n_connections; k++)
+    {
+        pthread_join(threads[k], NULL);
+        failed += conns[k].failed;
+    }
+
+    const double elapsed = now() - start;
+
+    if (failed)
+    {
+        fprintf(stderr, "Failed %d of %d Connections!\n", failed, n_connections);
+        return 1;
+    }
+
+    qsort(latency, n_requests, sizeof(double), compareDouble);
+
+    printf("%d Requests over %d Connections, %d in Flight Each, in %f Seconds\n", n_requests, n_connections, depth, elapsed);
+    printf("Throughput %.0f Requests/s, Latency p50 %.1f us, p99 %.1f us, Max %.1f us (Server Batches Up to %u)\n",
+           n_requests / elapsed, latency[n_requests / 2] * 1e6, latency[(int)(n_requests * 0.99)] * 1e6,
+           latency[n_requests - 1] * 1e6, hello.max_batch);
+
+    // Check Every Response Against a Local Single-Sample Pass of the Same Checkpoint
+
+    int rc = 0;
+
+    if (model_path != NULL)
+    {
+        Network *net = loadCheckpoint(model_path, NULL);
+        Workspace *ws = (net != NULL) ? createWorkspace(net, 1) : NULL;
+        double *in = malloc(in_n * sizeof(double));
+
+        if (ws == NULL || in == NULL || net->widths[0] != in_n || net->widths[net->n_layers] != out_n)
+        {
+            fprintf(stderr, "Failed to Load Checkpoint %s!\n", model_path);
+            return 1;
+        }
+
+        double max_diff = 0.0;
+
+        for (int r = 0; r < n_requests; r++)
+        {
+            makeInput(in, in_n, seed, (uint64_t)r);
+            activateNN(net, ws, in);
+
+            const double *expect = outputNN(net, ws);
+            for (int j = 0; j < out_n; j++)
+                max_diff = fmax(max_diff, fabs(expect[j] - out[(size_t)r * out_n + j]));
+        }
+
+        printf("Responses Match a Local Pass to %g\n", max_diff);
+        rc = (max_diff > 1e-6);
+
+        free(in);
+        freeWorkspace(ws);
+        freeNN(net);
+    }
+
+    free(out);
+    free(latency);
+    free(threads);
+    free(conns);
+
+    return rc;
+}
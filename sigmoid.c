@@ -0,0 +1,194 @@
+// ********************************************************************************
+// Scalar and Vectorized Sigmoid with Selectable Accuracy Tiers
+// ********************************************************************************
+
+// Include Libraries
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "sigmoid.h"
+
+// *******************************************************************
+// No unsafe-math-optimizations Here, It Would Fold Away the Rounding Trick Below
+#pragma GCC optimize("O3","unroll-loops","omit-frame-pointer","inline")
+//************************************************************
+
+// Definitions - Macros
+#define ExpClamp 700.0                  // exp() of Anything Larger Would Overflow 2^k
+#define Log2e 1.4426950408889634        // 1 / ln(2)
+#define Ln2Hi 6.93147180369123816490e-01    // ln(2) Split so k * Ln2Hi is Exact
+#define Ln2Lo 1.90821492927058770002e-10
+#define RoundMagic 6755399441055744.0   // 1.5 * 2^52, Adding It Rounds to an Integer
+#define RoundMagicBits 0x4338000000000000LL
+#define ExpClampF 87.0f                 // Single Precision Counterparts of the Above
+#define Log2eF 1.44269504f
+#define Ln2HiF 0.693359375f
+#define Ln2LoF -2.12194440e-4f
+#define RoundMagicF 12582912.0f         // 1.5 * 2^23
+#define RoundMagicBitsF 0x4B400000
+
+// Polynomial Tiers Are Cloned for the Baseline, AVX2+FMA and AVX-512 Levels,
+// so Each Layer Loop Runs at the Widest Vector Width the CPU Has
+#define SigmoidTargets __attribute__((target_clones("default", "arch=x86-64-v3", "arch=x86-64-v4")))
+
+static const char *tier_names[SigmoidTiers] = { "exact", "precise", "fast" };
+
+// ***********************************
+// Scalar Reference
+// ***********************************
+
+// Helper Function to Calculate Using Sigmoid Calculation
+double sigmoid(double x)
+{
+    return 1 / (1 + exp(-x));
+}
+
+// Helper Function to Calculate Using Derivative of Sigmoid Calculation
+double dSigmoid(double x)
+{
+    return x * (1 - x);
+}
+
+// ***********************************
+// Polynomial Sigmoid
+// ***********************************
+
+// Helper Function to Calculate sigmoid(d) = 1 / (1 + exp(-d)) Without libm
+// exp(x) = 2^k * exp(r), with k = round(x / ln 2) and |r| <= ln(2) / 2, and exp(r)
+// from a Taylor Polynomial of the Given Degree. Everything is Branch-Free Arithmetic
+// and Integer Bit Moves, so Loops Around It Vectorize
+static inline __attribute__((always_inline)) double sigmoidPoly(double d, const int degree)
+{
+    double x = -d;
+    x = (x > ExpClamp) ? ExpClamp : x;
+    x = (x < -ExpClamp) ? -ExpClamp : x;
+
+    // Round x / ln 2 to the Nearest Integer, Which Ends Up in the Low Mantissa Bits
+    double t = x * Log2e + RoundMagic;
+    double k = t - RoundMagic;
+    int64_t t_bits;
+    memcpy(&t_bits, &t, sizeof(t_bits));
+
+    double r = (x - k * Ln2Hi) - k * Ln2Lo;
+    double p;
+
+    if (degree == 6)
+        p = 1.0 + r * (1.0 + r * (1.0 / 2 + r * (1.0 / 6 + r * (1.0 / 24 + r * (1.0 / 120 + r * (1.0 / 720))))));
+    else
+        p = 1.0 + r * (1.0 + r * (1.0 / 2 + r * (1.0 / 6)));
+
+    // Build 2^k Directly in the Exponent Field, k Being t's Bits Minus RoundMagic's
+    int64_t scale_bits = (t_bits - RoundMagicBits + 1023) << 52;
+    double scale;
+    memcpy(&scale, &scale_bits, sizeof(scale));
+
+    return 1.0 / (1.0 + p * scale);
+}
+
+// Single Precision Version of the Above, Twice the Lanes per Vector
+static inline __attribute__((always_inline)) float sigmoidPolyF(float d, const int degree)
+{
+    float x = -d;
+    x = (x > ExpClampF) ? ExpClampF : x;
+    x = (x < -ExpClampF) ? -ExpClampF : x;
+
+    float t = x * Log2eF + RoundMagicF;
+    float k = t - RoundMagicF;
+    int32_t t_bits;
+    memcpy(&t_bits, &t, sizeof(t_bits));
+
+    float r = (x - k * Ln2HiF) - k * Ln2LoF;
+    float p;
+
+    if (degree == 6)
+        p = 1.0f + r * (1.0f + r * (1.0f / 2 + r * (1.0f / 6 + r * (1.0f / 24 + r * (1.0f / 120 + r * (1.0f / 720))))));
+    else
+        p = 1.0f + r * (1.0f + r * (1.0f / 2 + r * (1.0f / 6)));
+
+    int32_t scale_bits = (t_bits - RoundMagicBitsF + 127) << 23;
+    float scale;
+    memcpy(&scale, &scale_bits, sizeof(scale));
+
+    return 1.0f / (1.0f + p * scale);
+}
+
+SigmoidTargets static void sigmoidPrecise(const double *D, double *O, int n)
+{
+    for (int i = 0; i < n; i++)
+        O[i] = sigmoidPoly(D[i], 6);
+}
+
+SigmoidTargets static void sigmoidFast(const double *D, double *O, int n)
+{
+    for (int i = 0; i < n; i++)
+        O[i] = sigmoidPoly(D[i], 3);
+}
+
+SigmoidTargets static void sigmoidPreciseF(const float *D, float *O, int n)
+{
+    for (int i = 0; i < n; i++)
+        O[i] = sigmoidPolyF(D[i], 6);
+}
+
+SigmoidTargets static void sigmoidFastF(const float *D, float *O, int n)
+{
+    for (int i = 0; i < n; i++)
+        O[i] = sigmoidPolyF(D[i], 3);
+}
+
+// ***********************************
+// Layer Interface
+// ***********************************
+
+// Function to Apply the Sigmoid to n Pre-Activation Values at Once
+void sigmoidLayer(SigmoidTier tier, const double *D, double *O, int n)
+{
+    switch (tier)
+    {
+        case SigmoidPrecise:
+            sigmoidPrecise(D, O, n);
+            break;
+        case SigmoidFast:
+            sigmoidFast(D, O, n);
+            break;
+        default:
+            for (int i = 0; i < n; i++)
+                O[i] = sigmoid(D[i]);
+            break;
+    }
+}
+
+// Function to Apply the Sigmoid to n Single Precision Values at Once
+void sigmoidLayerF(SigmoidTier tier, const float *D, float *O, int n)
+{
+    switch (tier)
+    {
+        case SigmoidPrecise:
+            sigmoidPreciseF(D, O, n);
+            break;
+        case SigmoidFast:
+            sigmoidFastF(D, O, n);
+            break;
+        default:
+            for (int i = 0; i < n; i++)
+                O[i] = 1.0f / (1.0f + expf(-D[i]));
+            break;
+    }
+}
+
+// Helper Function to Get the Name of a Tier
+const char *sigmoidTierName(SigmoidTier tier)
+{
+    return (tier >= 0 && tier < SigmoidTiers) ? tier_names[tier] : "unknown";
+}
+
+// Helper Function to Parse a Tier Name, Returns -1 if Unknown
+int parseSigmoidTier(const char *name)
+{
+    for (int t = 0; t < SigmoidTiers; t++)
+        if (strcmp(name, tier_names[t]) == 0)
+            return t;
+
+    return -1;
+}
@@ -0,0 +1,31 @@
+// ********************************************************************************
+// Scalar and Vectorized Sigmoid with Selectable Accuracy Tiers
+// ********************************************************************************
+
+#ifndef SIGMOID_H
+#define SIGMOID_H
+
+// Accuracy Tiers, Maximum Absolute Error Against sigmoid()
+typedef enum
+{
+    SigmoidExact,       // libm exp(), Bit-Identical to sigmoid()
+    SigmoidPrecise,     // Degree 6 exp() Polynomial, Error Below 1e-7
+    SigmoidFast,        // Degree 3 exp() Polynomial, Error Below 1e-3
+    SigmoidTiers
+} SigmoidTier;
+
+// Helper Functions
+double sigmoid(double x);
+double dSigmoid(double x);
+
+// Function to Apply the Sigmoid to n Pre-Activation Values at Once
+void sigmoidLayer(SigmoidTier tier, const double *D, double *O, int n);
+
+// Single Precision Version, the Exact and Precise Tiers Limited by float Rounding (About 1e-7)
+void sigmoidLayerF(SigmoidTier tier, const float *D, float *O, int n);
+
+// Helpers to Convert Between Tiers and Their Names (exact, precise, fast)
+const char *sigmoidTierName(SigmoidTier tier);
+int parseSigmoidTier(const char *name);
+
+#endif
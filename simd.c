@@ -0,0 +1,385 @@
+// ********************************************************************************
+// SIMD Dot Product, GEMV and AXPY Kernels with Runtime CPU Dispatch
+// ********************************************************************************
+
+// Include Libraries
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <immintrin.h>
+
+#include "simd.h"
+
+// *******************************************************************
+#pragma GCC optimize("O3","unroll-loops","omit-frame-pointer","inline")
+//************************************************************
+
+// Each Kernel is Compiled for Its Own Instruction Set Through a Target Attribute,
+// so the Rest of the Binary Keeps the Baseline Architecture and Runs Anywhere
+#define TargetSSE2 __attribute__((target("sse2")))
+#define TargetAVX2 __attribute__((target("avx2,fma")))
+#define TargetAVX512 __attribute__((target("avx512f,avx2,fma")))
+
+// ***********************************
+// Scalar Kernels
+// ***********************************
+
+static double dotScalar(const double *a, const double *b, int n)
+{
+    double sum = 0.0;
+
+    for (int j = 0; j < n; j++)
+        sum += a[j] * b[j];
+
+    return sum;
+}
+
+static void gemvScalar(const double *W, int stride, int rows, const double *x, int n, double *y)
+{
+    for (int i = 0; i < rows; i++)
+        y[i] = dotScalar(W + (size_t)i * stride, x, n);
+}
+
+static void axpyScalar(double a, const double *x, double *y, size_t n)
+{
+    for (size_t j = 0; j < n; j++)
+        y[j] += a * x[j];
+}
+
+// ***********************************
+// SSE2 Kernels
+// ***********************************
+
+TargetSSE2 static inline double hsumSSE2(__m128d v)
+{
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+TargetSSE2 static double dotSSE2(const double *a, const double *b, int n)
+{
+    __m128d s0 = _mm_setzero_pd();
+    __m128d s1 = _mm_setzero_pd();
+    int j = 0;
+
+    for (; j + 4 <= n; j += 4)
+    {
+        s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(a + j), _mm_loadu_pd(b + j)));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(a + j + 2), _mm_loadu_pd(b + j + 2)));
+    }
+
+    double sum = hsumSSE2(_mm_add_pd(s0, s1));
+
+    for (; j < n; j++)
+        sum += a[j] * b[j];
+
+    return sum;
+}
+
+// Two Rows at a Time, so Each Load of x Feeds Two Products
+TargetSSE2 static void gemvSSE2(const double *W, int stride, int rows, const double *x, int n, double *y)
+{
+    int i = 0;
+
+    for (; i + 2 <= rows; i += 2)
+    {
+        const double *w0 = W + (size_t)i * stride;
+        const double *w1 = w0 + stride;
+        __m128d s0 = _mm_setzero_pd();
+        __m128d s1 = _mm_setzero_pd();
+        int j = 0;
+
+        for (; j + 2 <= n; j += 2)
+        {
+            __m128d xv = _mm_loadu_pd(x + j);
+            s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(w0 + j), xv));
+            s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(w1 + j), xv));
+        }
+
+        double y0 = hsumSSE2(s0);
+        double y1 = hsumSSE2(s1);
+
+        for (; j < n; j++)
+        {
+            y0 += w0[j] * x[j];
+            y1 += w1[j] * x[j];
+        }
+
+        y[i] = y0;
+        y[i + 1] = y1;
+    }
+
+    for (; i < rows; i++)
+        y[i] = dotSSE2(W + (size_t)i * stride, x, n);
+}
+
+TargetSSE2 static void axpySSE2(double a, const double *x, double *y, size_t n)
+{
+    __m128d av = _mm_set1_pd(a);
+    size_t j = 0;
+
+    for (; j + 2 <= n; j += 2)
+        _mm_storeu_pd(y + j, _mm_add_pd(_mm_loadu_pd(y + j), _mm_mul_pd(av, _mm_loadu_pd(x + j))));
+
+    for (; j < n; j++)
+        y[j] += a * x[j];
+}
+
+// ***********************************
+// AVX2 Kernels
+// ***********************************
+
+TargetAVX2 static inline double hsumAVX2(__m256d v)
+{
+    __m128d lo = _mm256_castpd256_pd128(v);
+    __m128d hi = _mm256_extractf128_pd(v, 1);
+
+    lo = _mm_add_pd(lo, hi);
+
+    return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+TargetAVX2 static double dotAVX2(const double *a, const double *b, int n)
+{
+    __m256d s0 = _mm256_setzero_pd();
+    __m256d s1 = _mm256_setzero_pd();
+    __m256d s2 = _mm256_setzero_pd();
+    __m256d s3 = _mm256_setzero_pd();
+    int j = 0;
+
+    for (; j + 16 <= n; j += 16)
+    {
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + j), _mm256_loadu_pd(b + j), s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + j + 4), _mm256_loadu_pd(b + j + 4), s1);
+        s2 = _mm256_fmadd_pd(_mm256_loadu_pd(a + j + 8), _mm256_loadu_pd(b + j + 8), s2);
+        s3 = _mm256_fmadd_pd(_mm256_loadu_pd(a + j + 12), _mm256_loadu_pd(b + j + 12), s3);
+    }
+
+    for (; j + 4 <= n; j += 4)
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + j), _mm256_loadu_pd(b + j), s0);
+
+    double sum = hsumAVX2(_mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+
+    for (; j < n; j++)
+        sum += a[j] * b[j];
+
+    return sum;
+}
+
+// Four Rows at a Time, so Each Load of x Feeds Four FMAs
+TargetAVX2 static void gemvAVX2(const double *W, int stride, int rows, const double *x, int n, double *y)
+{
+    int i = 0;
+
+    for (; i + 4 <= rows; i += 4)
+    {
+        const double *w0 = W + (size_t)i * stride;
+        const double *w1 = w0 + stride;
+        const double *w2 = w1 + stride;
+        const double *w3 = w2 + stride;
+        __m256d s0 = _mm256_setzero_pd();
+        __m256d s1 = _mm256_setzero_pd();
+        __m256d s2 = _mm256_setzero_pd();
+        __m256d s3 = _mm256_setzero_pd();
+        int j = 0;
+
+        for (; j + 4 <= n; j += 4)
+        {
+            __m256d xv = _mm256_loadu_pd(x + j);
+            s0 = _mm256_fmadd_pd(_mm256_loadu_pd(w0 + j), xv, s0);
+            s1 = _mm256_fmadd_pd(_mm256_loadu_pd(w1 + j), xv, s1);
+            s2 = _mm256_fmadd_pd(_mm256_loadu_pd(w2 + j), xv, s2);
+            s3 = _mm256_fmadd_pd(_mm256_loadu_pd(w3 + j), xv, s3);
+        }
+
+        // Transpose-Reduce the Four Accumulators into One Vector of Four Sums
+
+        __m256d h01 = _mm256_hadd_pd(s0, s1);
+        __m256d h23 = _mm256_hadd_pd(s2, s3);
+        __m256d sums = _mm256_add_pd(_mm256_permute2f128_pd(h01, h23, 0x20),
+                                     _mm256_permute2f128_pd(h01, h23, 0x31));
+        double out[4];
+        _mm256_storeu_pd(out, sums);
+
+        for (; j < n; j++)
+        {
+            out[0] += w0[j] * x[j];
+            out[1] += w1[j] * x[j];
+            out[2] += w2[j] * x[j];
+            out[3] += w3[j] * x[j];
+        }
+
+        y[i] = out[0];
+        y[i + 1] = out[1];
+        y[i + 2] = out[2];
+        y[i + 3] = out[3];
+    }
+
+    for (; i < rows; i++)
+        y[i] = dotAVX2(W + (size_t)i * stride, x, n);
+}
+
+TargetAVX2 static void axpyAVX2(double a, const double *x, double *y, size_t n)
+{
+    __m256d av = _mm256_set1_pd(a);
+    size_t j = 0;
+
+    for (; j + 4 <= n; j += 4)
+        _mm256_storeu_pd(y + j, _mm256_fmadd_pd(av, _mm256_loadu_pd(x + j), _mm256_loadu_pd(y + j)));
+
+    for (; j < n; j++)
+        y[j] += a * x[j];
+}
+
+// ***********************************
+// AVX-512 Kernels
+// ***********************************
+
+TargetAVX512 static double dotAVX512(const double *a, const double *b, int n)
+{
+    __m512d s0 = _mm512_setzero_pd();
+    __m512d s1 = _mm512_setzero_pd();
+    int j = 0;
+
+    for (; j + 16 <= n; j += 16)
+    {
+        s0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + j), _mm512_loadu_pd(b + j), s0);
+        s1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + j + 8), _mm512_loadu_pd(b + j + 8), s1);
+    }
+
+    for (; j + 8 <= n; j += 8)
+        s0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + j), _mm512_loadu_pd(b + j), s0);
+
+    // Masked Tail, Padded Rows Never Get Here
+
+    if (j < n)
+    {
+        __mmask8 m = (__mmask8)((1u << (n - j)) - 1);
+        s1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, a + j), _mm512_maskz_loadu_pd(m, b + j), s1);
+    }
+
+    return _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+}
+
+// Four Rows at a Time, so Each Load of x Feeds Four FMAs
+TargetAVX512 static void gemvAVX512(const double *W, int stride, int rows, const double *x, int n, double *y)
+{
+    const int tail = n & 7;
+    const __mmask8 m = (__mmask8)((1u << tail) - 1);
+    int i = 0;
+
+    for (; i + 4 <= rows; i += 4)
+    {
+        const double *w0 = W + (size_t)i * stride;
+        const double *w1 = w0 + stride;
+        const double *w2 = w1 + stride;
+        const double *w3 = w2 + stride;
+        __m512d s0 = _mm512_setzero_pd();
+        __m512d s1 = _mm512_setzero_pd();
+        __m512d s2 = _mm512_setzero_pd();
+        __m512d s3 = _mm512_setzero_pd();
+        int j = 0;
+
+        for (; j + 8 <= n; j += 8)
+        {
+            __m512d xv = _mm512_loadu_pd(x + j);
+            s0 = _mm512_fmadd_pd(_mm512_loadu_pd(w0 + j), xv, s0);
+            s1 = _mm512_fmadd_pd(_mm512_loadu_pd(w1 + j), xv, s1);
+            s2 = _mm512_fmadd_pd(_mm512_loadu_pd(w2 + j), xv, s2);
+            s3 = _mm512_fmadd_pd(_mm512_loadu_pd(w3 + j), xv, s3);
+        }
+
+        if (tail)
+        {
+            __m512d xv = _mm512_maskz_loadu_pd(m, x + j);
+            s0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, w0 + j), xv, s0);
+            s1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, w1 + j), xv, s1);
+            s2 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, w2 + j), xv, s2);
+            s3 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, w3 + j), xv, s3);
+        }
+
+        y[i] = _mm512_reduce_add_pd(s0);
+        y[i + 1] = _mm512_reduce_add_pd(s1);
+        y[i + 2] = _mm512_reduce_add_pd(s2);
+        y[i + 3] = _mm512_reduce_add_pd(s3);
+    }
+
+    for (; i < rows; i++)
+        y[i] = dotAVX512(W + (size_t)i * stride, x, n);
+}
+
+TargetAVX512 static void axpyAVX512(double a, const double *x, double *y, size_t n)
+{
+    __m512d av = _mm512_set1_pd(a);
+    size_t j = 0;
+
+    for (; j + 8 <= n; j += 8)
+        _mm512_storeu_pd(y + j, _mm512_fmadd_pd(av, _mm512_loadu_pd(x + j), _mm512_loadu_pd(y + j)));
+
+    if (j < n)
+    {
+        __mmask8 m = (__mmask8)((1u << (n - j)) - 1);
+        _mm512_mask_storeu_pd(y + j, m, _mm512_fmadd_pd(av, _mm512_maskz_loadu_pd(m, x + j), _mm512_maskz_loadu_pd(m, y + j)));
+    }
+}
+
+// ***********************************
+// Dispatch
+// ***********************************
+
+static const SimdKernels kernel_sets[] =
+{
+    { "avx512", dotAVX512, gemvAVX512, axpyAVX512 },
+    { "avx2", dotAVX2, gemvAVX2, axpyAVX2 },
+    { "sse2", dotSSE2, gemvSSE2, axpySSE2 },
+    { "scalar", dotScalar, gemvScalar, axpyScalar },
+};
+
+// Chosen Once per Process, Before Any Thread Can Read It
+static const SimdKernels *selected = NULL;
+static pthread_once_t select_once = PTHREAD_ONCE_INIT;
+
+// Helper Function to Check Whether This CPU Can Run a Kernel Set
+static int cpuSupports(const SimdKernels *k)
+{
+    __builtin_cpu_init();
+
+    if (k->dot == dotAVX512)
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (k->dot == dotAVX2)
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (k->dot == dotSSE2)
+        return __builtin_cpu_supports("sse2");
+
+    return 1;
+}
+
+// Helper Function to Choose the Best Kernels for This CPU, or Those Named by EBP_SIMD
+static void selectKernels(void)
+{
+    const int n_sets = (int)(sizeof(kernel_sets) / sizeof(kernel_sets[0]));
+    const char *force = getenv("EBP_SIMD");
+    const SimdKernels *best = &kernel_sets[n_sets - 1];
+
+    for (int k = 0; k < n_sets; k++)
+    {
+        if (force != NULL && strcmp(force, kernel_sets[k].name) != 0)
+            continue;
+
+        if (cpuSupports(&kernel_sets[k]))
+        {
+            best = &kernel_sets[k];
+            break;
+        }
+    }
+
+    selected = best;
+}
+
+// Function to Get the Best Kernels for This CPU, Chosen on First Call
+// Safe to Call from Many Threads at Once, Every Caller Sees the Same Choice
+const SimdKernels *simdKernels(void)
+{
+    pthread_once(&select_once, selectKernels);
+
+    return selected;
+}
@@ -0,0 +1,31 @@
+// ********************************************************************************
+// SIMD Dot Product, GEMV and AXPY Kernels with Runtime CPU Dispatch
+// ********************************************************************************
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stddef.h>
+
+// One Instruction Set's Kernels
+// Vectors Are Padded Network Rows, so n is Normally a Multiple of PadN and Every
+// Row Starts on a Cache Line, but the Kernels Accept Any n and Alignment
+typedef struct
+{
+    const char *name;
+
+    // Dot Product of a[n] and b[n]
+    double (*dot)(const double *a, const double *b, int n);
+
+    // y[i] = Dot Product of Row i of W[rows][stride] and x[n], for All rows
+    void (*gemv)(const double *W, int stride, int rows, const double *x, int n, double *y);
+
+    // y[n] += a * x[n], n Can Span a Whole Weight Arena
+    void (*axpy)(double a, const double *x, double *y, size_t n);
+} SimdKernels;
+
+// Function to Get the Best Kernels for This CPU, Chosen on First Call
+// Setting EBP_SIMD to scalar, sse2, avx2 or avx512 Forces a Specific Set
+const SimdKernels *simdKernels(void);
+
+#endif
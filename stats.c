@@ -0,0 +1,177 @@
+// ********************************************************************************
+// Per-Phase Training Timers and Counters, Compiled Out Unless EBP_STATS is Defined
+// ********************************************************************************
+
+#define _POSIX_C_SOURCE 200809L
+
+// Include Libraries
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "stats.h"
+
+// Definitions - Macros
+#define CalibrateNs 20000000L       // Span the Clock is Measured Against CLOCK_MONOTONIC Over
+
+static const char *phase_names[Phases] = { "Forward", "Error", "Deltas", "Update" };
+
+// Seconds per Tick, Measured Once per Process
+static double tick_seconds = 0;
+static pthread_once_t calibrate_once = PTHREAD_ONCE_INIT;
+
+// ***********************************
+// Helper Functions
+// ***********************************
+
+// Helper Function to Get Monotonic Time in Seconds
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+// Helper Function to Time the Clock Against CLOCK_MONOTONIC
+static void calibrate(void)
+{
+    const struct timespec span = { 0, CalibrateNs };
+    const double t0 = now();
+    const uint64_t c0 = statClock();
+
+    nanosleep(&span, NULL);
+
+    const uint64_t c1 = statClock();
+    const double t1 = now();
+
+    tick_seconds = (c1 > c0) ? (t1 - t0) / (double)(c1 - c0) : 1e-9;
+}
+
+// Helper Function to Get a Phase's Name
+const char *phaseName(Phase phase)
+{
+    return (phase >= 0 && phase < Phases) ? phase_names[phase] : "unknown";
+}
+
+// Helper Function to Convert Clock Ticks to Seconds
+double statSeconds(uint64_t ticks)
+{
+    pthread_once(&calibrate_once, calibrate);
+
+    return (double)ticks * tick_seconds;
+}
+
+// Helper Function to Sum Every Thread's Counters
+void sumStats(const StatsReporter *r, PhaseStats *sum)
+{
+    memset(sum, 0, sizeof(*sum));
+
+    for (int t = 0; t < r->n_threads; t++)
+    {
+        const PhaseStats *s = r->stats[t];
+
+        if (s == NULL)
+            continue;
+
+        for (int p = 0; p < Phases; p++)
+        {
+            sum->ticks[p] += s->ticks[p];
+            sum->calls[p] += s->calls[p];
+        }
+        sum->samples += s->samples;
+    }
+}
+
+// Helper Function to Get the Busy Ticks of a Set of Counters, All Phases Together
+static uint64_t busyTicks(const PhaseStats *s)
+{
+    uint64_t busy = 0;
+
+    for (int p = 0; p < Phases; p++)
+        busy += s->ticks[p];
+
+    return busy;
+}
+
+// ***********************************
+// Reporting
+// ***********************************
+
+// Function to Start Reporting, Before the First Epoch
+void startStats(StatsReporter *r, PhaseStats *const *stats, int n_threads, double interval, int first_epoch)
+{
+    memset(r, 0, sizeof(*r));
+
+    r->stats = stats;
+    r->n_threads = n_threads;
+    r->interval = interval;
+    r->first_epoch = first_epoch;
+    r->last_epoch = first_epoch - 1;
+
+    sumStats(r, &r->seen);
+    statSeconds(0);             // Calibrate Now Rather Than in the Middle of Training
+    r->start = r->last = statClock();
+}
+
+// Function to Print a Stats Line for the Time Since the Last if interval Has Passed
+// Phase Shares Are of the Time Spent in Any Phase, Busy is That Time over Wall Time and Threads
+void tickStats(StatsReporter *r, int epoch)
+{
+    const uint64_t clock = statClock();
+    const double seconds = statSeconds(clock - r->last);
+
+    if (seconds < r->interval)
+        return;
+
+    PhaseStats sum;
+    sumStats(r, &sum);
+
+    const uint64_t busy = busyTicks(&sum) - busyTicks(&r->seen);
+    int threads = 0;
+
+    for (int t = 0; t < r->n_threads; t++)
+        threads += (r->stats[t] != NULL);
+
+    printf("Stats: Epoch %d, %.0f Samples/s, %.2f Epochs/s,", epoch, (sum.samples - r->seen.samples) / seconds,
+           (epoch - r->last_epoch) / seconds);
+    for (int p = 0; p < Phases; p++)
+        printf(" %s %.1f%%,", phase_names[p], busy ? 100.0 * (sum.ticks[p] - r->seen.ticks[p]) / busy : 0.0);
+    printf(" Busy %.1f%%\n", threads ? 100.0 * statSeconds(busy) / (seconds * threads) : 0.0);
+    fflush(stdout);
+
+    r->seen = sum;
+    r->last = clock;
+    r->last_epoch = epoch;
+}
+
+// Function to Print Where the Time Went over the Whole Run, Per Phase and Per Thread
+void finishStats(StatsReporter *r, int epoch)
+{
+    const double seconds = statSeconds(statClock() - r->start);
+    const int epochs = epoch - r->first_epoch + 1;
+    PhaseStats sum;
+
+    sumStats(r, &sum);
+
+    const uint64_t busy = busyTicks(&sum);
+
+    printf("Stats Summary: %d Epochs in %f s, %.0f Samples/s, %.2f Epochs/s\n", epochs, seconds,
+           seconds > 0 ? sum.samples / seconds : 0.0, seconds > 0 ? epochs / seconds : 0.0);
+    printf("%-10s %12s %8s %14s %12s\n", "Phase", "Seconds", "Share", "Calls", "ns/Call");
+
+    for (int p = 0; p < Phases; p++)
+        printf("%-10s %12.6f %7.1f%% %14llu %12.1f\n", phase_names[p], statSeconds(sum.ticks[p]),
+               busy ? 100.0 * sum.ticks[p] / busy : 0.0, (unsigned long long)sum.calls[p],
+               sum.calls[p] ? statSeconds(sum.ticks[p]) * 1e9 / sum.calls[p] : 0.0);
+
+    for (int t = 0; t < r->n_threads; t++)
+    {
+        if (r->stats[t] == NULL)
+            continue;
+
+        printf("Thread %d: %.1f%% Utilized, %llu Samples\n", t,
+               seconds > 0 ? 100.0 * statSeconds(busyTicks(r->stats[t])) / seconds : 0.0,
+               (unsigned long long)r->stats[t]->samples);
+    }
+}
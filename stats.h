@@ -0,0 +1,89 @@
+// ********************************************************************************
+// Per-Phase Training Timers and Counters, Compiled Out Unless EBP_STATS is Defined
+// ********************************************************************************
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+// Phases of a Training Step
+typedef enum
+{
+    PhaseForward,       // Activation, Single and Batched
+    PhaseError,         // Error of the Last Activation
+    PhaseDeltas,        // Output Deltas, and Hidden Ones Where Computed Apart from the Update
+    PhaseUpdate,        // Weight Updates (with Hidden Deltas Where Fused), Gradient Sums and Their Reduction
+    Phases
+} Phase;
+
+// Time and Calls per Phase, Kept in Each Workspace and Only Written by Its Owner
+typedef struct
+{
+    uint64_t ticks[Phases];
+    uint64_t calls[Phases];
+    uint64_t samples;           // Samples Trained On
+} PhaseStats;
+
+// Periodic Stats Lines and a Final Summary over Every Thread's Workspace
+typedef struct
+{
+    PhaseStats *const *stats;   // One per Thread, NULL Entries Are Skipped
+    int n_threads;
+    double interval;            // Seconds Between Stats Lines
+    uint64_t start;             // Clock at the Start of Training
+    uint64_t last;              // Clock at the Last Line
+    int first_epoch;
+    int last_epoch;             // Epoch of the Last Line
+    PhaseStats seen;            // Totals at the Last Line
+} StatsReporter;
+
+// Helper Function to Read the Cheapest Clock There Is, the Time Stamp Counter on x86
+static inline uint64_t statClock(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+#endif
+}
+
+// Timers Around the Hot Paths, Nothing at All is Compiled in Without EBP_STATS
+#ifdef EBP_STATS
+
+#define StatBegin(t) const uint64_t t = statClock()
+#define StatEnd(stats, phase, t) ((stats)->ticks[phase] += statClock() - (t), (stats)->calls[phase]++)
+#define StatSamples(stats, n) ((stats)->samples += (uint64_t)(n))
+
+#else
+
+#define StatBegin(t)
+#define StatEnd(stats, phase, t) ((void)0)
+#define StatSamples(stats, n) ((void)0)
+
+#endif
+
+// Helper Functions
+const char *phaseName(Phase phase);
+double statSeconds(uint64_t ticks);
+void sumStats(const StatsReporter *r, PhaseStats *sum);
+
+// Function to Start Reporting, Before the First Epoch
+void startStats(StatsReporter *r, PhaseStats *const *stats, int n_threads, double interval, int first_epoch);
+
+// Function to Print a Stats Line for the Time Since the Last if interval Has Passed, Called After Each Epoch
+// Every Thread Must Be Between Epochs, so Nothing is Being Written Meanwhile
+void tickStats(StatsReporter *r, int epoch);
+
+// Function to Print Where the Time Went over the Whole Run, Per Phase and Per Thread
+void finishStats(StatsReporter *r, int epoch);
+
+#endif